@@ -7,280 +7,352 @@
  * chunks of codes.
  * due to the fact that the functions here are made to be available in other modules,
  * they are all public.
+ * the parser, prints and memory allocation related functions, which only
+ * the console uses, are in Console.c, so the engine (libsudoku) prints
+ * nothing and never exits: when there is not enough memory, its functions
+ * fail and leave the game as it was.
  * contents:
- * 1. parser related functions.
- * 2. erroneous cells related functions.
- * 3. saving and loading related functions.
- * 4. cells and indices related functions.
- * 5. moves-list related functions.
- * 6. set related functions.
- * 7. generate related functions.
- * 8. stack related functions.
- * 9. demi-values related functions.
- * 10. autofill related functions.
- * 11. prints related functions.
- * 12. memory allocation related functions.
+ * 1. erroneous cells related functions.
+ * 2. saving and loading related functions.
+ * 3. cells and indices related functions.
+ * 4. moves-log related functions.
+ * 5. set related functions.
+ * 6. generate related functions.
+ * 7. demi-values related functions.
+ * 8. autofill related functions.
+ * 9. solutions related functions.
+ * 10. board hash related functions.
  *
  */
 
 #include "DataStructures.h"
 #include "AuxMethods.h"
-#include "Game.h"
-#include "Validate.h"
+#include "Solver.h"
+#include "Propagation.h"
+#include "Kernels.h"
+#include "GridPool.h"
+#include "SolutionCache.h"
+#include "Sudoku.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+
+#define LOG_START 64 /*number of moves the moves-log is created with*/
+#define CHECKPOINT_STEPS 32 /*number of steps between two checkpoints of the moves-log*/
+#define BOARD_PAD 15 /*bytes after the last value, as the kernels read past it (see unitMatches)*/
+#define BITSET_WORDS(size) (((size) + 31)/32) /*words in a bitset of 'size' bits*/
+#define BITSET_WORD(n) ((n)/32) /*the word of bit n in a bitset*/
+#define BITSET_BIT(n) (1u << ((n)%32)) /*the mask of bit n within its word*/
+#define MOVE_CELL_MASK 1023u /*a cell number takes bits 0-9 of a Move*/
+#define MOVE_VAL_MASK 31u /*a value takes 5 bits of a Move*/
+#define MOVE_OLD_SHIFT 10
+#define MOVE_NEW_SHIFT 15
+#define MOVE_GROUP (1u << 20) /*marks a group header, which holds the group's length in bits 0-19*/
+#define MOVE_LENGTH_MASK (MOVE_GROUP - 1)
 
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- *                          1. PARSER                              *
+ *                      1. ERRONEOUS CELLS                         *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 
 /*
- * isNum:
- * ------
+ * cellUnits:
+ * ----------
  * arguments:
- * st - string to be evaluated.
+ * g - the game.
+ * col - cell's column.
+ * row - cell's row.
+ * units - an array of 3 ints, filled with the row, column and block
+ *         units (see Kernels.c) of cell <col,row>.
  * description:
- * if st represents an integer:
- * 	   returns true.
- * else:
- *     returns false.
+ * lists the units of cell <col,row>.
  */
-int isNum(char *st){
-	int i = 0;
-	char c = st[i];
-	while(c!='\0')
-	{
-		if (((int)c<48) || ((int)c>57))
-			return 0;
-		i++;
-		c = st[i];
-	}
-	return 1;
+void cellUnits(Game *g, int col, int row, int *units) {
+	int N = g->N;
+	units[0] = row;
+	units[1] = N + col;
+	units[2] = 2*N + getBlock(g, col,row);
 }
 
 /*
- * hasNewLine:
- * -----------
+ * isConflicting:
+ * --------------
  * arguments:
- * input - string to be evaluated.
+ * g - the game.
+ * col - cell's column.
+ * row - cell's row.
+ * val - the value of cell <col,row> (not 0).
  * description:
- * if input[] contains new-line or EOF:
- *     returns true.
- * else:
- *     returns false.
+ * returns 1 iff another cell in the row, column or block
+ * of cell <col,row> holds 'val', according to the unit counters.
  */
-int hasNewLine(char input[]) {
-	int counter = 0;
-	while (counter < 256) {
-		if (input[counter] == 10 || feof(stdin)) {
+int isConflicting(Game *g, int col, int row, int val) {
+	int i, units[3];
+	cellUnits(g, col, row, units);
+	for (i = 0; i < 3; i++) {
+		if (g->unitCount[units[i]*g->N + val - 1] > 1) {
 			return 1;
 		}
-		counter++;
 	}
 	return 0;
 }
 
-/* parseMarkErrorInput:
- * --------------------
+/*
+ * otherHolder:
+ * ------------
  * arguments:
- * token - string to be parsed.
+ * g - the game.
+ * unit - a unit of cell <col,row>.
+ * val - a value held by exactly one cell of 'unit' other than <col,row>.
+ * col - cell's column.
+ * row - cell's row.
  * description:
- * an implementation of a deterministic finite automata
- * to determine whether the int value of input is 1 (returns 1),
- * 0 (returns 0) or neither (returns -1).
+ * returns the number (left to right, then top to bottom) of the
+ * cell of 'unit', other than <col,row>, that holds 'val'.
  */
-int parseMarkErrorInput(char * token) {
-	int state, mark, i;
-	while (1) {
-		if (state == 0) { /*state 0 is the starting state*/
-			if (token[i] == '0') {
-				state = 1;
-				i++;
-				continue;
-			}
-			if (token[i] == '1') {
-				state = 2;
-				i++;
-				continue;
-			}
-			mark = -1;
-			break;
-		}
-		if (state == 1) { /*state 1 means input so far is "0*" */
-			if (token[i] == '0') {
-				i++;
-				continue;
-			}
-			if (token[i] == '1') {
-				state = 2;
-				i++;
-				continue;
-			}
-			if (token[i] == 0) {
-				mark = 0;
-				break;
-			}
-			mark = -1;
-			break;
-		}
-		if (state == 2) { /*state 2 means input so far is "0*1" */
-			if (token[i] == 0) {
-				mark = 1;
-				break;
-			}
-			mark = -1;
-			break;
-		}
-	}
-	return mark;
+int otherHolder(Game *g, int unit, int val, int col, int row) {
+	unsigned int matches = unitMatches(g, unit, val) & ~(1u << unitPosition(g, unit, col, row));
+	return unitCell(g, unit, lowestBitIndex(matches));
 }
 
-
-/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- *                      2. ERRONEOUS CELLS                         *
- * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
-
-
 /*
- * checkIfError:
- * -------------
+ * removeFromUnits:
+ * ----------------
  * arguments:
- * col - column no. of the evaluated cell.
- * row - row no. of the evaluated cell.
- * val - new value of the evaluated cell.
- * old - old value of the evaluated cell.
+ * g - the game.
+ * col - cell's column.
+ * row - cell's row.
+ * old - the value removed from cell <col,row> (not 0).
  * description:
- * checks whether assigning the new value 'val' to cell <col,row>
- * requires updating the isError status of cell <col,row>.
- * additionally, calls isErrorUpdate in order to update
- * all cells affected by the changing of cell <col,row>'s
- * value to 'val.
+ * decrements the counters of 'old' in the row, column and block of
+ * cell <col,row>, and unmarks it as used in the units it has left.
+ * a unit in which a single cell still holds 'old' may have been what made
+ * that cell erroneous, so its status is checked again.
  */
-void checkIfError(int col, int row, int val, int old){
-
-	int i,j,xx,yy, f=0;
-
-	/*if val==0 dont mark errors, but check whether other cells are still erroneous*/
-	if (val == 0) {
-		if ((getCell(col,row)->isError == 1) && (!f) && (val!=old)) /* val(col,row) was changed, we have to check if it's neighbors are still erroneous*/
-			isErrorUpdate(col, row, old);
-		getCell(col,row)->isError = 0;
-		return;
-	}
-
-	/*check whether this val already exists in col*/
-	for (i=0;i<myGame.N; i++){
-		if (i == row) {
-			continue;
+void removeFromUnits(Game *g, int col, int row, int old) {
+	int i, n, count, units[3];
+	unsigned int bit = valueBit(old);
+	unsigned int *masks[3];
+
+	masks[0] = g->rowMask + row;
+	masks[1] = g->colMask + col;
+	masks[2] = g->blockMask + getBlock(g, col,row);
+	cellUnits(g, col, row, units);
+	for (i = 0; i < 3; i++) {
+		count = --g->unitCount[units[i]*g->N + old - 1];
+		if (count == 0) {
+			*masks[i] &= ~bit;
+		} else if (count == 1) {
+			n = otherHolder(g, units[i], old, col, row);
+			setErrorStatus(g, n, isConflicting(g, getCol(g, n), getRow(g, n), old));
 		}
-		if (getCell(col,i)->val == val){
-			f=1;
-			getCell(col,i)->isError = 1;}
 	}
+}
 
-	/*check whther this val already exists in row*/
-	for (i=0; i<myGame.N; i++){
-		if (i==col) {
-			continue;
+/*
+ * addToUnits:
+ * -----------
+ * arguments:
+ * g - the game.
+ * col - cell's column.
+ * row - cell's row.
+ * val - the value placed in cell <col,row> (not 0).
+ * description:
+ * increments the counters of 'val' in the row, column and block of
+ * cell <col,row>, and marks it as used in them. a unit that had a single
+ * cell holding 'val' makes that cell erroneous.
+ */
+void addToUnits(Game *g, int col, int row, int val) {
+	int i, count, units[3];
+	unsigned int bit = valueBit(val);
+
+	g->rowMask[row] |= bit;
+	g->colMask[col] |= bit;
+	g->blockMask[getBlock(g, col,row)] |= bit;
+	cellUnits(g, col, row, units);
+	for (i = 0; i < 3; i++) {
+		count = ++g->unitCount[units[i]*g->N + val - 1];
+		if (count == 2) {
+			setErrorStatus(g, otherHolder(g, units[i], val, col, row), 1);
 		}
-		if (getCell(i,row)->val == val){
-			f=1;
-			getCell(i,row)->isError = 1;}
 	}
+}
 
-	/*check whther this val already exists in this block*/
-	xx = col - col%myGame.blockW;
-	yy = row - row%myGame.blockH;
-	for (i=0; i <myGame.blockW ; i++){
-		for (j=0; j < myGame.blockH ; j ++){
-			if ((getCell(xx+i,yy+j)->val ==val) && (((xx+i)!=col) || ((yy+j)!=row))){
-				f=1;
-				getCell(xx+i,yy+j)->isError = 1;}
-		}
+/*
+ * setErrorStatus:
+ * ---------------
+ * arguments:
+ * g - the game.
+ * n - cell's number (counting left to right, then top to bottom).
+ * isError - the cell's new isError status.
+ * description:
+ * sets the isError status of the n'th cell, and updates the number of
+ * erroneous cells (g->errorCount) accordingly.
+ */
+void setErrorStatus(Game *g, int n, int isError) {
+	g->errorCount += isError - isErrorCell(g, n);
+	if (isError) {
+		g->errorBits[BITSET_WORD(n)] |= BITSET_BIT(n);
+	} else {
+		g->errorBits[BITSET_WORD(n)] &= ~BITSET_BIT(n);
 	}
+}
 
-	/* val(col,row) was changed, we have to check if it's neighbors are still erroneous*/
-	if ((getCell(col,row)->isError == 1)  && (val!=old))
-		isErrorUpdate(col, row, old);
-
-	/*update cell(col,row) isError value*/
-	getCell(col,row)->isError = f;
-
+/*
+ * lowestBitIndex:
+ * ---------------
+ * arguments:
+ * mask - a non-zero mask.
+ * description:
+ * returns the index of the lowest set bit in 'mask'.
+ */
+int lowestBitIndex(unsigned int mask) {
+	int i = 0;
+	while (!(mask & 1u)) {
+		mask >>= 1;
+		i++;
+	}
+	return i;
 }
 
 /*
- * isErrorUpdate:
- * --------------
+ * valueBit:
+ * ---------
  * arguments:
- * col - column of the updated cell.
- * row - row of the updated cell.
- * old - old value of the updated cell.
+ * val - a cell value (0 to N).
  * description:
- * updates the isError value of cell <col,row>.
- * Additionally, calls checkIfError for neighboring
- * cells, if necessary.
+ * returns the bit representing 'val' in the used-values masks
+ * (bit val-1), or 0 if val is 0.
  */
-void isErrorUpdate(int col, int row, int old){
-	int i, j, xx, yy;
+unsigned int valueBit(int val) {
+	if (val == 0) {
+		return 0;
+	}
+	return 1u << (val - 1);
+}
 
-	/*check whether old val exists in col*/
-	for (i=0; i<myGame.N; i++){
-		if (i==row) {
+/*
+ * recountBoard:
+ * -------------
+ * arguments:
+ * g - the game.
+ * description:
+ * recomputes, from the values of the cells alone, everything that
+ * updateCellStatus keeps up to date: numFilled, the unit counters and
+ * used-values masks, the isError status of every cell and errorCount,
+ * the board hash and the solution cache. takes O(N*N), unlike a change
+ * of every cell.
+ */
+void recountBoard(Game *g) {
+	int n, i, val, col, row, N = g->N, units[3];
+
+	g->numFilled = 0;
+	g->errorCount = 0;
+	g->hash.hi = g->hash.lo = 0;
+	memset(g->unitCount, 0, 3*N*N*sizeof(int));
+	memset(g->rowMask, 0, N*sizeof(unsigned int));
+	memset(g->colMask, 0, N*sizeof(unsigned int));
+	memset(g->blockMask, 0, N*sizeof(unsigned int));
+	memset(g->errorBits, 0, BITSET_WORDS(N*N)*sizeof(unsigned int));
+
+	/*count the values, first*/
+	for (n = 0; n < N*N; n++) {
+		val = g->vals[n];
+		if (!val) {
 			continue;
 		}
-		if (getCell(col,i)->val == old){
-			checkIfError(col, i, old, old);
+		col = getCol(g, n);
+		row = getRow(g, n);
+		g->numFilled++;
+		toggleKey(&g->hash, n, val);
+		g->rowMask[row] |= valueBit(val);
+		g->colMask[col] |= valueBit(val);
+		g->blockMask[getBlock(g, col,row)] |= valueBit(val);
+		cellUnits(g, col, row, units);
+		for (i = 0; i < 3; i++) {
+			g->unitCount[units[i]*N + val - 1]++;
 		}
 	}
 
-	/*check whether old val exists in row*/
-	for (i=0; (i<myGame.N); i++){
-		if (i == col) {
-			continue;
-		}
-		if (getCell(i,row)->val == old){
-			checkIfError(i ,row, old, old);
+	/*then mark the erroneous cells*/
+	for (n = 0; n < N*N; n++) {
+		val = g->vals[n];
+		if (val && isConflicting(g, getCol(g, n), getRow(g, n), val)) {
+			setErrorStatus(g, n, 1);
 		}
 	}
+	recountSolutionCache(g);
+}
 
-	/*check whether this val already exists in this block*/
-	xx = col - col%myGame.blockW;
-	yy = row - row%myGame.blockH;
-	for (i=0; i <myGame.blockW ; i++){
-		for (j=0; j < myGame.blockH ; j ++){
-			if ((getCell(xx+i,yy+j)->val ==old) && (((xx+i)!=col) || ((yy+j)!=row))){
-				checkIfError(xx+i,yy+j, old, old);}
+/*
+ * updateCellStatus:
+ * -----------------
+ * arguments:
+ * g - the game.
+ * col - column of the changed cell.
+ * row - row of the changed cell.
+ * val - new value of the cell.
+ * old - old value of the cell.
+ * description:
+ * to be called after cell <col,row>'s value was changed from 'old' to 'val'.
+ * updates the unit counters and used-values masks, the isError status of
+ * the cell and the neighbors it stopped or started clashing with, the
+ * solution cache and the board hash.
+ * a cell is erroneous iff one of its units counts its value more than once,
+ * so only the three units of the cell are updated, and no unit is rescanned.
+ */
+void updateCellStatus(Game *g, int col, int row, int val, int old) {
+	int n = getN(g, col, row);
+	if (val != old) {
+		if (old) {
+			removeFromUnits(g, col, row, old);
 		}
+		if (val) {
+			addToUnits(g, col, row, val);
+		}
+		setErrorStatus(g, n, val && isConflicting(g, col, row, val));
 	}
+	updateSolutionCache(g, n, val, old);
+	toggleKey(&g->hash, n, old);
+	toggleKey(&g->hash, n, val);
+}
+
+/*
+ * getCandidates:
+ * --------------
+ * arguments:
+ * g - the game.
+ * col - cell's column.
+ * row - cell's row.
+ * description:
+ * returns a mask of the values that are not used in the row, column
+ * or block of the (empty) cell <col,row>.
+ */
+unsigned int getCandidates(Game *g, int col, int row) {
+	unsigned int used = g->rowMask[row] | g->colMask[col] | g->blockMask[getBlock(g, col,row)];
+	return ~used & ((1u << g->N) - 1);
 }
 
 /*
  * isErroneus:
  * -----------
  * arguments:
- * none.
+ * g - the game.
  * description:
  * if board contains erroneus values:
  *     returns true.
  * else:
  *     returns false.
+ * the erroneous cells are counted as they are marked, so no cell is scanned.
  */
-int isErroneous(){
-	int i,j;
-	for (i=0; i<myGame.N;i++){
-		for(j=0; j<myGame.N;j++){
-			if (getCell(i,j)->isError)
-				return 1;
-		}
-	}
-	return 0;
+int isErroneous(Game *g){
+	return g->errorCount != 0;
 }
 
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- *                      3. SAVING AND LOADING                      *
+ *                      2. SAVING AND LOADING                      *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 
@@ -291,12 +363,15 @@ int isErroneous(){
  * ifp - pointer to a FILE to read from.
  * description:
  * reads the next 1-5 integer from ifp,
- * returns it in int format.
+ * returns it in int format, or 0 if the file ends first.
  */
 int readSize(FILE *ifp){
-	char c = fgetc(ifp);
-	while (c!='1' && c!='2' && c!='3' && c!='4' && c!='5')
+	int c = fgetc(ifp);
+	while (c!='1' && c!='2' && c!='3' && c!='4' && c!='5') {
+		if (c == EOF)
+			return 0;
 		c = fgetc(ifp);
+	}
 	return (c - 48);
 }
 
@@ -305,40 +380,36 @@ int readSize(FILE *ifp){
  * -------------
  * arguments:
  * ifp - pointer to a FILE to read from.
- * cell - pointer to a cell to parse the data from the file into.
+ * N - the number of values of the board.
+ * val - set to the value of the cell.
+ * fixed - set to 1 if the cell is fixed, 0 otherwise.
  * description:
- * reads the next integer representing a cell from 'ifp',
- * and fills 'cell' accordingly.
+ * reads the next integer representing a cell from 'ifp'.
+ * returns 0 if the file ends first, or the value is greater than N,
+ * and 1 otherwise.
  */
-void readNextCell(FILE *ifp, Cell *cell) {
-	char c;
-	int val, fixed = 0;
+int readNextCell(FILE *ifp, int N, int *val, int *fixed) {
+	int c;
 
-	/*skip over whitespaces (since saved files are guaranteed to be valid, we can assume non-integer chars are whitespace).*/
+	/*skip over whitespaces (non-integer chars are taken as whitespace), until the file ends*/
 	c=fgetc(ifp);
 	while ( c!='0' && c!='1' && c!='2' && c!='3' && c!='4' && c!='5' && c!='6' && c!='7' && c!='8' && c!='9') {
+		if (c == EOF)
+			return 0;
 		c=fgetc(ifp);
 	}
 
 	/*parse an int*/
-	val = c - 48;
+	*val = c - 48;
 	c=fgetc(ifp);
 	if (c=='0' || c=='1' || c=='2' || c=='3' || c=='4' || c=='5' || c=='6' || c=='7' || c=='8' || c=='9') {
-		val = 10*val + (c - 48);
+		*val = 10*(*val) + (c - 48);
 		c=fgetc(ifp);
 	}
 
 	/*parse cell's 'fixed' status*/
-	if ( c == '.') {
-		fixed = 1;
-	}
-	cell->val = val;
-	cell->isFixed = fixed;
-
-	/*update the game parameters*/
-	if (val) {
-		myGame.numFilled++;
-	}
+	*fixed = (c == '.');
+	return *val <= N;
 }
 
 /*
@@ -376,17 +447,18 @@ int writeSize(FILE *ifp, int height, int width){
  * writeCell:
  * ----------
  * arguments:
+ * g - the game.
  * ifp - pointer to a FILE to write into.
- * cell - pointer to the cell to be saved.
+ * n - the number (left to right, then top to bottom) of the cell to be saved.
  * val - the value of the saved cell.
  * description:
- * saves 'cell' into ifp according the saving format.
+ * saves the n'th cell into ifp according the saving format.
  * if successful:
  *     returns true.
  * else:
  *     returns false.
  */
-int writeCell(FILE *ifp, Cell *cell, int val){
+int writeCell(Game *g, FILE *ifp, int n, int val){
 	int v1,f;
 	if (val<=9){ /*case where the value is single-digit*/
 		v1 = val + 48;
@@ -406,7 +478,7 @@ int writeCell(FILE *ifp, Cell *cell, int val){
 	}
 
 	/*write a '.' if cell should be considered fixed.*/
-	if (((myGame.mode == Edit) && (val!=0)) || (cell->isFixed)){
+	if (((g->mode == Edit) && (val!=0)) || isFixedCell(g, n)){
 		f = fputc('.',ifp);
 		if (!f)
 			return 0;}
@@ -422,18 +494,19 @@ int writeCell(FILE *ifp, Cell *cell, int val){
  * writeCellEndOfLine:
  * -------------------
  * arguments:
+ * g - the game.
  * ifp - pointer to the FILE that is to be written into.
- * cell - pointer to the cell to be saved.
+ * n - the number (left to right, then top to bottom) of the cell to be saved.
  * val - the value of the saved cell.
  * description:
- * saves 'cell' into ifp according the saving format,
- * when 'cell' is in the end of a line.
+ * saves the n'th cell into ifp according the saving format,
+ * when it is in the end of a line.
  * if successful:
  *     returns true.
  * else:
  *     returns false.
  */
-int writeCellEndOfLine(FILE *ifp, Cell *cell, int val){
+int writeCellEndOfLine(Game *g, FILE *ifp, int n, int val){
 	int v1,f;
 	if (val<=9){ /*case where the value is single-digit*/
 		v1 = val + 48;
@@ -451,7 +524,7 @@ int writeCellEndOfLine(FILE *ifp, Cell *cell, int val){
 			return 0;}
 
 	/*write a '.' if cell should be considered fixed.*/
-	if (((myGame.mode == Edit) && (val!=0)) || (cell->isFixed)){
+	if (((g->mode == Edit) && (val!=0)) || isFixedCell(g, n)){
 		f = fputc('.',ifp);
 		if (!f)
 			return 0;}
@@ -462,46 +535,161 @@ int writeCellEndOfLine(FILE *ifp, Cell *cell, int val){
 	return 1;
 }
 
+/*
+ * initGame:
+ * ---------
+ * arguments:
+ * g - the game.
+ * description:
+ * prepares 'g' to be used, with no board allocated: in INIT mode,
+ * with errors marked. to be called once, before any other use of 'g'.
+ */
+void initGame(Game *g) {
+	memset(g, 0, sizeof(Game));
+	g->mode = Init;
+	g->markErrors = 1;
+}
+
+/*
+ * seedGame:
+ * ---------
+ * arguments:
+ * g - the game.
+ * seed - any number.
+ * description:
+ * starts the random numbers of 'g' (used by generate) from 'seed'.
+ * a game that was never seeded always generates the same puzzles.
+ */
+void seedGame(Game *g, unsigned long seed) {
+	g->rng = seed;
+}
+
+/*
+ * freeGame:
+ * ---------
+ * arguments:
+ * g - the game.
+ * description:
+ * frees the board, the moves-log and the solution cache of 'g', if
+ * they were allocated, so 'g' has no board. 'g' can be created again
+ * (see createGame).
+ */
+void freeGame(Game *g) {
+	if (g->notNew) {
+		free(g->log.moves);
+		free(g->log.checkpoints);
+		free(g->log.checkpointVals);
+		free(g->vals);
+		free(g->demiVals);
+		free(g->initVals);
+		free(g->fixedBits);
+		free(g->errorBits);
+		free(g->rowMask);
+		free(g->colMask);
+		free(g->blockMask);
+		free(g->unitCount);
+		free(g->unitCells);
+		g->notNew = 0;
+	}
+	g->blockW = 0;
+	g->blockH = 0;
+	g->N = 0;
+	clearSolutionCache(g);
+}
+
 /*
  * createGame:
  * -----------
  * arguments:
+ * g - the game.
  * blockW - block width.
  * blockH - block height.
  * m - game mode.
  * description:
- * initializes the board and all other myGame parameters in
+ * initializes the board and all other parameters of g in
  * preparation for a new game, according to the block-height,
  * block-width and game-mode provided.
+ * returns 1 on success, and 0 if there is not enough memory (then
+ * 'g' has no board).
  */
-void createGame(int blockW, int blockH, enum Mode m) {
+int createGame(Game *g, int blockW, int blockH, enum Mode m) {
 
 	/*if not the first time initialized, clear old memory*/
-	if (myGame.notNew) {
-		while (myGame.currMove != myGame.sentinel) {
-			undoAny();
-		}
-		clearNextMoves();
-		free(myGame.sentinel);
-		free(myGame.board);
+	freeGame(g);
 
+	/*allocate new memory*/
+	g->log.numMoves = 0;
+	g->log.curr = 0;
+	g->log.capacity = LOG_START;
+	g->log.groupStart = -1;
+	g->log.moves = malloc(LOG_START*sizeof(Move));
+	g->log.step = 0;
+	g->log.numSteps = 0;
+	g->log.numCheckpoints = 0;
+	g->log.checkpointCapacity = 0;
+	g->log.checkpoints = NULL;
+	g->log.checkpointVals = NULL;
+	g->numFilled = 0;
+	g->errorCount = 0;
+	g->hash.hi = g->hash.lo = 0; /*the hash of the empty board*/
+	g->blockH = blockH;
+	g->blockW = blockW;
+	g->N = blockH*blockW;
+	g->mode = m;
+	g->vals = calloc(g->N*g->N + BOARD_PAD, 1);
+	g->demiVals = calloc(g->N*g->N, 1);
+	g->initVals = calloc(g->N*g->N, 1); /*the empty board*/
+	g->fixedBits = calloc(BITSET_WORDS(g->N*g->N), sizeof(unsigned int));
+	g->errorBits = calloc(BITSET_WORDS(g->N*g->N), sizeof(unsigned int));
+	g->rowMask = calloc(UNIT_PAD, sizeof(unsigned int)); /*padded, as the kernels load them as vectors*/
+	g->colMask = calloc(UNIT_PAD, sizeof(unsigned int));
+	g->blockMask = calloc(UNIT_PAD, sizeof(unsigned int));
+	g->unitCount = calloc(3*g->N*g->N, sizeof(int));
+	g->unitCells = malloc(4*3*g->N*UNIT_PAD*sizeof(int));
+	g->notNew = 1;
+	if (!g->log.moves || !g->vals || !g->demiVals || !g->initVals || !g->fixedBits || !g->errorBits
+			|| !g->rowMask || !g->colMask || !g->blockMask || !g->unitCount || !g->unitCells) {
+		freeGame(g);
+		return 0;
 	}
+	g->unitRows = g->unitCells + 3*g->N*UNIT_PAD;
+	g->unitCols = g->unitRows + 3*g->N*UNIT_PAD;
+	g->unitBlocks = g->unitCols + 3*g->N*UNIT_PAD;
+	createUnitLayouts(g);
+	return 1;
+}
 
-	/*allocate new memory*/
-	myGame.sentinel = createMove(0,0,0,0,0);
-	myGame.currMove = myGame.sentinel;
-	myGame.numFilled = 0;
-	myGame.blockH = blockH;
-	myGame.blockW = blockW;
-	myGame.N = blockH*blockW;
-	myGame.mode = m;
-	myGame.board = calloc(myGame.N*myGame.N, sizeof(Cell));
-	myGame.notNew = 1;
+/*
+ * takeSnapshot:
+ * -------------
+ * arguments:
+ * g - the game.
+ * description:
+ * copies the board's values into g->initVals, as the board reset returns to.
+ * to be called once a board was loaded, before any move is made.
+ */
+void takeSnapshot(Game *g) {
+	memcpy(g->initVals, g->vals, g->N*g->N);
+}
+
+/*
+ * restoreSnapshot:
+ * ----------------
+ * arguments:
+ * g - the game.
+ * description:
+ * copies g->initVals back into the board, and recomputes everything
+ * derived from the board's values at once (recountBoard), instead of
+ * undoing the moves one by one. the moves-log is left to the caller.
+ */
+void restoreSnapshot(Game *g) {
+	memcpy(g->vals, g->initVals, g->N*g->N);
+	recountBoard(g);
 }
 
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- *                      4. CELLS AND INDICES                       *
+ *                      3. CELLS AND INDICES                       *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 
@@ -509,566 +697,833 @@ void createGame(int blockW, int blockH, enum Mode m) {
  * getRow:
  * -------
  * arguments:
+ * g - the game.
  * n - cell's number (counting left to right, then top to bottom).
  * description:
  * returns the number of the row of the n'th cell
  * in the board.
  */
-int getRow(int n) {
-	return n/myGame.N;
+int getRow(Game *g, int n) {
+	return n/g->N;
 }
 
 /*
  * getCol:
  * -------
  * arguments:
+ * g - the game.
  * n - cell's number (counting left to right, then top to bottom).
  * description:
  * returns the number of the column of the n'th cell
  * in the board.
  */
-int getCol(int n) {
-	return n%myGame.N;
+int getCol(Game *g, int n) {
+	return n%g->N;
 }
 
 /*
  * getN:
  * -----
  * arguments:
+ * g - the game.
  * col - cell's column.
  * row - cell's row.
  * description:
  * returns the number (when counting left to right,
  * then top to bottom) of the cell in position <col,row>.
  */
-int getN(int col, int row) {
-	return row*myGame.N + col;
+int getN(Game *g, int col, int row) {
+	return row*g->N + col;
 }
 
 /*
- * getCell:
- * --------
+ * getBlock:
+ * ---------
  * arguments:
+ * g - the game.
  * col - cell's column.
  * row - cell's row.
  * description:
- * returns a pointer to the cell in position <col,row>.
+ * returns the number (when counting left to right,
+ * then top to bottom) of the block containing cell <col,row>.
  */
-Cell* getCell(int col, int row) {
-	return myGame.board + getN(col, row);
+int getBlock(Game *g, int col, int row) {
+	return (row/g->blockH)*g->blockH + col/g->blockW;
 }
 
 /*
- * getCellN:
- * ---------
+ * getVal:
+ * -------
  * arguments:
+ * g - the game.
  * n - cell's number (counting left to right, then top to bottom).
  * description:
- * returns a pointer to the n'th cell in the board.
+ * returns the value of the n'th cell (0 if empty).
  */
-Cell* getCellN(int n) {
-	return myGame.board + n;
+int getVal(Game *g, int n) {
+	return g->vals[n];
 }
 
 /*
- * nextEmptyCell:
- * --------------
+ * setVal:
+ * -------
  * arguments:
- * i - current cell's number (counting left to right, then top to bottom).
+ * g - the game.
+ * n - cell's number (counting left to right, then top to bottom).
+ * val - the new value of the cell (0 to N).
  * description:
- * returns the index of the next empty cell after cell number i.
- * if there is no such cell, returns N*N.
+ * stores 'val' as the value of the n'th cell. nothing else is updated
+ * (see updateCellStatus).
  */
-int nextEmptyCell(int i){
-	if (i >= myGame.N*myGame.N) {
-		return i;
-	}
-	while (getCellN(i)->val) {
-		i++;
-		if (i >= myGame.N*myGame.N) {
-			return i;
-		}
-	}
-	return i;
+void setVal(Game *g, int n, int val) {
+	g->vals[n] = (unsigned char)val;
 }
 
-
-/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- *                          5. MOVES-LIST                          *
- * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
-
-
 /*
- * createMove:
+ * getDemiVal:
  * -----------
  * arguments:
- * col - cell's column.
- * row - cell's row.
- * oldVal - cell's old value.
- * newVal - cell's new value.
- * user - indicates whether the move was user-made or automatic.
+ * g - the game.
+ * n - cell's number (counting left to right, then top to bottom).
  * description:
- * returns a pointer to a new MovesList instance.
+ * returns the demi-value of the n'th cell (see section 8).
  */
-MovesList* createMove(int col, int row, int oldVal, int newVal, int user) {
-	MovesList *newMove = safealloc(sizeof(MovesList));
-	newMove->row = row;
-	newMove->col = col;
-	newMove->oldVal = oldVal;
-	newMove->newVal = newVal;
-	newMove->user = user;
-	newMove->next = NULL;
-	newMove->prev = NULL;
-	return newMove;
+int getDemiVal(Game *g, int n) {
+	return g->demiVals[n];
 }
 
 /*
- * addMove:
- * --------
+ * setDemiVal:
+ * -----------
  * arguments:
- * col - cell's column.
- * row - cell's row.
- * oldVal - cell's old value.
- * newVal - cell's new value.
- * user - indicates whether the move was user-made or automatic.
- * description:
- * adds a move to the moves-list, after one marked as current,
- * and updates the list accordingly.
- */
-void addMove(int col, int row, int oldVal, int newVal, int user) {
-	MovesList *newMove = createMove(col, row, oldVal, newVal, user);
-	clearNextMoves();
-	/*if lastmove isnt null, connect pointers from lastmove to newmove*/
-	if (myGame.currMove != NULL) {
-		myGame.currMove->next = newMove;
-		newMove->prev = myGame.currMove;
-	}
-	/*make newmove the last move*/
-	myGame.currMove = newMove;
+ * g - the game.
+ * n - cell's number (counting left to right, then top to bottom).
+ * val - the new demi-value of the cell (0 to N).
+ * description:
+ * stores 'val' as the demi-value of the n'th cell.
+ */
+void setDemiVal(Game *g, int n, int val) {
+	g->demiVals[n] = (unsigned char)val;
 }
 
 /*
- * clearNextMoves:
- * ---------------
+ * isFixedCell:
+ * ------------
  * arguments:
- * none.
+ * g - the game.
+ * n - cell's number (counting left to right, then top to bottom).
  * description:
- * clears all the moves after the current move in the moves-list.
+ * returns 1 if the n'th cell is fixed, 0 otherwise.
  */
-void clearNextMoves(void) {
-	MovesList *pcurr, *pnext;
-	/*case: there are no moves*/
-	if ( myGame.currMove == NULL) return;
-	/*case: current move is the last move*/
-	pcurr = myGame.currMove->next;
-	if (pcurr==NULL) {
-		myGame.currMove->next = NULL;
-		return;
-	}
-	/*case: current move is the move before the last*/
-	pnext = pcurr->next;
-	if (pnext == NULL) {
-		free(pcurr);
-		myGame.currMove->next = NULL;
-		return;
-	}
-	/*case: there are 2 or more moves after currMove*/
-	while (pnext->next != NULL) {
-		free(pcurr);
-		pcurr = pnext;
-		pnext = pcurr->next;
-	}
-	free(pcurr);
-	free(pnext);
-	myGame.currMove->next = NULL;
+int isFixedCell(Game *g, int n) {
+	return (g->fixedBits[BITSET_WORD(n)] & BITSET_BIT(n)) != 0;
 }
 
 /*
- * undoAny:
- * --------
+ * setFixedCell:
+ * -------------
  * arguments:
- * none.
+ * g - the game.
+ * n - cell's number (counting left to right, then top to bottom).
+ * isFixed - the cell's new isFixed status.
  * description:
- * reverts the current move in moves-list,
- * and updates the board and moves-list accordingly.
+ * marks the n'th cell as fixed or not fixed.
  */
-void undoAny(void) {
-	MovesList m = *myGame.currMove;
-	Cell *c = getCell(m.col, m.row);
-	c->val = m.oldVal;
-	myGame.currMove = myGame.currMove->prev;
-	if (!(m.oldVal) && (m.newVal)) {
-		myGame.numFilled--;
+void setFixedCell(Game *g, int n, int isFixed) {
+	if (isFixed) {
+		g->fixedBits[BITSET_WORD(n)] |= BITSET_BIT(n);
+	} else {
+		g->fixedBits[BITSET_WORD(n)] &= ~BITSET_BIT(n);
 	}
-	if ((m.oldVal) && !(m.newVal)) {
-		myGame.numFilled++;
-	}
-	checkIfError(m.col, m.row, m.oldVal, m.newVal);
 }
 
 /*
- * redoAny:
- * --------
+ * isErrorCell:
+ * ------------
  * arguments:
- * none.
+ * g - the game.
+ * n - cell's number (counting left to right, then top to bottom).
  * description:
- * redoes a move.
- * updates the board and moveslist accordingly.
+ * returns 1 if the n'th cell is marked as erroneous, 0 otherwise
+ * (see setErrorStatus).
  */
-void redoAny(void) {
-	MovesList m;
-	Cell *c;
-	myGame.currMove = myGame.currMove->next;
-	m = *myGame.currMove;
-	c = getCell(m.col, m.row);
-	c->val = m.newVal;
-	if (!(m.oldVal) && (m.newVal)) {
-		myGame.numFilled++;
-	}
-	if ((m.oldVal) && !(m.newVal)) {
-		myGame.numFilled--;
-	}
-	checkIfError(m.col, m.row, m.newVal, m.oldVal);
+int isErrorCell(Game *g, int n) {
+	return (g->errorBits[BITSET_WORD(n)] & BITSET_BIT(n)) != 0;
 }
 
 
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- *                             6. SET                              *
+ *                          4. MOVES-LOG                           *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 
 /*
- * setCell:
- * --------
+ * packMove:
+ * ---------
  * arguments:
- * col - cell's column.
- * row - cell's row.
+ * n - the number (left to right, then top to bottom) of the cell.
+ * oldVal - cell's old value.
  * newVal - cell's new value.
- * user - indicates whether the move was user-made or automatic.
  * description:
- * sets cell <col,row> to value newVal, and marks it as
- * user-made or automatic move according to 'user'.
- * updates the moves-list, and the board.
+ * returns the move, packed into a single Move (see DataStructures.h).
  */
-void setCell(int col, int row, int newVal, int user) {
-	int oldVal;
-	Cell *pcell;
-
-	pcell = getCell(col, row);
-	oldVal = pcell->val;
-	pcell->val = newVal;
-	addMove(col, row, oldVal, newVal, user);
-
-	/*update numFilled*/
-	if ((oldVal == 0) && (newVal != 0))
-		myGame.numFilled++;
-	if ((oldVal != 0) && (newVal == 0))
-		myGame.numFilled--;
-
-	checkIfError(col, row, newVal, oldVal);
-
-	if ((myGame.mode == Solve) && (myGame.numFilled == myGame.N*myGame.N)) {/*if this is the last cell to be filled*/
-		printgb();
-		if (!ILPvalidate()) /*validation failed*/
-			printf("Puzzle solution erroneous\n");
-		else{
-			printf("Puzzle solved successfully\n");
-			myGame.mode = Init;
-		}
-	}
+Move packMove(int n, int oldVal, int newVal) {
+	return (Move)n | (Move)oldVal << MOVE_OLD_SHIFT | (Move)newVal << MOVE_NEW_SHIFT;
 }
 
-
-/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- *                           7. GENERATE                           *
- * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
-
-
 /*
- * randInt:
- * --------
+ * moveCell:
+ * ---------
  * arguments:
- * range - the range from which the random int will be chosen.
+ * m - a move.
  * description:
- * returns a random integer between 0-(range-1).
+ * returns the number (left to right, then top to bottom) of the cell of move 'm'.
  */
-int randInt(int range) {
-	return rand()%range;
+int moveCell(Move m) {
+	return m & MOVE_CELL_MASK;
 }
 
 /*
- * clearBoard:
+ * moveOldVal:
  * -----------
  * arguments:
- * none.
+ * m - a move.
  * description:
- * clears the values of every cell in the board.
+ * returns the value of the cell before move 'm'.
  */
-void clearBoard() {
-	int size = myGame.N*myGame.N, i=0;
-	Cell *cell;
-	for (;i<size; i++) {
-		cell = getCellN(i);
-		cell->val = 0;
-	}
+int moveOldVal(Move m) {
+	return (m >> MOVE_OLD_SHIFT) & MOVE_VAL_MASK;
 }
 
 /*
- * tryGenerate:
- * ------------
+ * moveNewVal:
+ * -----------
  * arguments:
- * x - number of cells to be randomly filled.
- * y - number of cells not to be erased.
+ * m - a move.
  * description:
- * attempts to fill X cells with random legal values, and then
- * if the board is valid, erases all but Y cells.
- * if successful:
- *     returns true.
- * else:
- *     returns false
- */
-int tryGenerate(int x, int y) {
-	int size = myGame.N*myGame.N, counter = 0, n = 0;
-	Cell *cell;
-	/*fill X cells with random legal values:*/
-	while (counter < x) {
-		n = randInt(size);
-		cell = getCellN(n);
-		if (cell->val !=0) continue;
-		n = randInt(myGame.N) + 1;
-		cell->val = n;
-		counter++;
-	}
-
-	/*if board isnt valid, return 0*/
-	if (!ILPvalidate()) {
-		clearBoard();
-		return 0;
-	}
-	/*copy all demiVals to vals, so the board is solved*/
-	copyDemivalsToVals();
-	/*if board is valid, choose Y cells to preserve :*/
-	clearDemiVals(0);
-	counter = 0;
-	while (counter < y) {
-		cell = getCellN(randInt(size));
-		if (cell->demiVal == 0) {
-			cell->demiVal = cell->val + 26; /*we add 26 to val, so we would later be able to recognize 0-valued cells too*/
-			counter++;
-		}
-	}
-
-	/*clear all cells*/
-	clearBoard();
-
-	/*set the Y cells that were chosen:*/
-	counter = 0;
-	n = 0;
-	while (counter < y) { /*set the y-1 first cells*/
-		cell = getCellN(n);
-		if (cell->demiVal != 0) {
-			if (cell->demiVal != 26) setCell(getCol(n), getRow(n), cell->demiVal - 26, 0);
-			cell->demiVal = 0;
-			counter++;
-		}
-		n++;
-	}
-	myGame.currMove->user = 1;
-
-	return 1;
+ * returns the value of the cell after move 'm'.
+ */
+int moveNewVal(Move m) {
+	return (m >> MOVE_NEW_SHIFT) & MOVE_VAL_MASK;
 }
 
-
-
-/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- *                            8. STACK                             *
- * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
-
+/*
+ * isGroupHeader:
+ * --------------
+ * arguments:
+ * m - a record of the moves-log.
+ * description:
+ * returns 1 iff 'm' is the header of a group of moves, and not a move.
+ */
+int isGroupHeader(Move m) {
+	return (m & MOVE_GROUP) != 0;
+}
 
 /*
- * createElem:
- * -----------
+ * appendRecord:
+ * -------------
  * arguments:
- * cellIndex = the requested cellIndex value for the new Elem.
+ * g - the game.
+ * m - a record (a move or a group header).
  * description:
- * returns a pointer to a new Elem
+ * adds 'm' to the moves-log, after the current record, dropping the
+ * records that could have been redone. the caller makes room for it
+ * first (see reserveMoves).
  */
-Elem *createElem(int cellIndex){
-	Elem *e = safealloc(sizeof(Elem));
-	if (!e)
-		return NULL;
-	e->cellIndex = cellIndex;
-	return e;
+void appendRecord(Game *g, Move m) {
+	MovesLog *log = &g->log;
+	clearNextMoves(g);
+	log->moves[log->curr++] = m;
+	log->numMoves = log->curr;
 }
 
 /*
- * push:
- * -----
+ * reserveMoves:
+ * -------------
  * arguments:
- * st - the stack to push into
- * cellIndex - the desired cellIndex value for the new Elem to be pushed into the stack.
+ * g - the game.
+ * numRecords - the number of records about to be added (a group of k
+ *              moves takes k+2 records: the moves and two headers).
  * description:
- * attempts to push the stack st with a new Elem
- * containing the value cellIndex.
- * returns 1 iff new Elem was created and pushed successfully.
+ * makes room in the moves-log for 'numRecords' records after the current
+ * one, which make up a single step, and for the checkpoint of that step,
+ * doubling the arrays when they are too small. to be called before a
+ * command changes the board, so a command that can't be recorded is not
+ * made at all.
+ * returns 1 on success, and 0 if there is not enough memory (then the
+ * moves-log is left as it was).
  */
-int push (Stack *st, int cellIndex){
-	Elem *e = createElem(cellIndex);
-	if (!e)
-		return 0;
-	e->next = st->top;
-	st->top = e;
-	st->numOfElements++ ;
+int reserveMoves(Game *g, int numRecords) {
+	MovesLog *log = &g->log;
+	int capacity, size = g->N*g->N;
+	int needed = (log->step + 1)/CHECKPOINT_STEPS;
+	Move *moves;
+	int *records;
+	unsigned char *vals;
+
+	if (log->curr + numRecords > log->capacity) {
+		capacity = 2*log->capacity;
+		while (capacity < log->curr + numRecords) {
+			capacity *= 2;
+		}
+		moves = malloc(capacity*sizeof(Move));
+		if (moves == NULL) {
+			return 0;
+		}
+		memcpy(moves, log->moves, log->curr*sizeof(Move));
+		free(log->moves);
+		log->moves = moves;
+		log->capacity = capacity;
+	}
+	if (needed > log->checkpointCapacity) {
+		capacity = (2*log->checkpointCapacity > needed) ? 2*log->checkpointCapacity : needed;
+		records = malloc(capacity*sizeof(int));
+		vals = malloc(capacity*size);
+		if (records == NULL || vals == NULL) {
+			free(records);
+			free(vals);
+			return 0;
+		}
+		memcpy(records, log->checkpoints, log->numCheckpoints*sizeof(int));
+		memcpy(vals, log->checkpointVals, log->numCheckpoints*size);
+		free(log->checkpoints);
+		free(log->checkpointVals);
+		log->checkpoints = records;
+		log->checkpointVals = vals;
+		log->checkpointCapacity = capacity;
+	}
 	return 1;
 }
 
 /*
- * pop:
- * ----
+ * saveCheckpoint:
+ * ---------------
  * arguments:
- * st - the stack to be popped.
+ * g - the game.
  * description:
- * removes the top of stack st,
- * and returns a pointer to it.
+ * stores the values of the board, and the position of the cursor, as the
+ * checkpoint of the current step (a multiple of CHECKPOINT_STEPS).
+ * the room for it was made by reserveMoves.
  */
-Elem *pop(Stack *st){
-	Elem *e;
-	if (!(st->numOfElements))
-		return NULL;
-	st->numOfElements--;
-	e = st->top;
-	st->top = e->next;
-	return e;
-}
+void saveCheckpoint(Game *g) {
+	MovesLog *log = &g->log;
+	int n, i = log->step/CHECKPOINT_STEPS - 1, size = g->N*g->N;
 
+	log->checkpoints[i] = log->curr;
+	for (n = 0; n < size; n++) {
+		log->checkpointVals[i*size + n] = g->vals[n];
+	}
+	log->numCheckpoints = i + 1;
+}
 
-/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- *                         9. DEMI-VALUES                          *
- * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/*
+ * stepDone:
+ * ---------
+ * arguments:
+ * g - the game.
+ * description:
+ * to be called after a new step (a move or a group of moves) was added
+ * to the moves-log. counts it, and saves a checkpoint every CHECKPOINT_STEPS steps.
+ */
+void stepDone(Game *g) {
+	MovesLog *log = &g->log;
+	log->numSteps = ++log->step;
+	if (log->step % CHECKPOINT_STEPS == 0) {
+		saveCheckpoint(g);
+	}
+}
 
+/*
+ * addMove:
+ * --------
+ * arguments:
+ * g - the game.
+ * col - cell's column.
+ * row - cell's row.
+ * oldVal - cell's old value.
+ * newVal - cell's new value.
+ * description:
+ * adds a move to the moves-log, after the current move, dropping the
+ * moves that could have been redone. unless a group of moves is open,
+ * the move is a step of its own.
+ */
+void addMove(Game *g, int col, int row, int oldVal, int newVal) {
+	appendRecord(g, packMove(getN(g, col, row), oldVal, newVal));
+	if (g->log.groupStart < 0) {
+		stepDone(g);
+	}
+}
 
 /*
- * clearDemiVals:
- * --------------
+ * beginMoveGroup:
+ * ---------------
  * arguments:
- * i - the number (left to right, then top to bottom) of the cell that all
- * cells with number greater than it, will be cleared.
+ * g - the game.
  * description:
- * clears the demiVals of all cells with index
- * greater than i.
+ * starts a group of moves: all the moves added until endMoveGroup
+ * is called are undone and redone at once, as a single step.
  */
-void clearDemiVals(int i) {
+void beginMoveGroup(Game *g) {
+	appendRecord(g, MOVE_GROUP); /*a place for the header, filled by endMoveGroup*/
+	g->log.groupStart = g->log.curr - 1;
+}
 
-	for (; i < myGame.N*myGame.N; i++) {
-		getCellN(i)->demiVal = 0;
+/*
+ * endMoveGroup:
+ * -------------
+ * arguments:
+ * g - the game.
+ * description:
+ * closes the group of moves started by beginMoveGroup. the group is
+ * stored as a header, its moves, and a copy of the header, both holding the
+ * number of moves, so a step can be found from either of its ends in O(1).
+ * a group of a single move is stored as a plain move, and an empty group
+ * is dropped.
+ */
+void endMoveGroup(Game *g) {
+	MovesLog *log = &g->log;
+	int start = log->groupStart, length = log->curr - start - 1;
+
+	log->groupStart = -1;
+	if (length <= 1) {
+		if (length == 1) {
+			log->moves[start] = log->moves[start + 1];
+		}
+		log->curr = log->numMoves = start + length;
+	} else {
+		log->moves[start] = MOVE_GROUP | (Move)length;
+		appendRecord(g, log->moves[start]);
+	}
+	if (length > 0) {
+		stepDone(g);
 	}
+}
 
+/*
+ * stepAt:
+ * -------
+ * arguments:
+ * g - the game.
+ * record - the index in the moves-log of the first record of a step.
+ * first - set to the index in the moves-log of the first move of the step.
+ * description:
+ * returns the number of moves in the step that starts at 'record'.
+ */
+int stepAt(Game *g, int record, int *first) {
+	Move m = g->log.moves[record];
+	int length = isGroupHeader(m) ? (int)(m & MOVE_LENGTH_MASK) : 1;
+	*first = record + isGroupHeader(m);
+	return length;
 }
 
 /*
- * copyValsToDemivals:
- * -------------------
+ * lastStep:
+ * ---------
  * arguments:
- * none.
+ * g - the game.
+ * first - set to the index in the moves-log of the first move of the step.
  * description:
- * for every cell in board:
- *     val = demiVal.
+ * finds the step (a single move or a group of moves) before the cursor,
+ * which undoAny would undo. there must be one.
+ * returns the number of moves in the step.
  */
-void copyValsToDemivals() {
+int lastStep(Game *g, int *first) {
+	Move m = g->log.moves[g->log.curr - 1];
+	int length = isGroupHeader(m) ? (int)(m & MOVE_LENGTH_MASK) : 1;
+	*first = g->log.curr - length - isGroupHeader(m);
+	return length;
+}
 
-	int i;
+/*
+ * nextStep:
+ * ---------
+ * arguments:
+ * g - the game.
+ * first - set to the index in the moves-log of the first move of the step.
+ * description:
+ * finds the step (a single move or a group of moves) after the cursor,
+ * which redoAny would redo. there must be one.
+ * returns the number of moves in the step.
+ */
+int nextStep(Game *g, int *first) {
+	return stepAt(g, g->log.curr, first);
+}
+
+/*
+ * clearNextMoves:
+ * ---------------
+ * arguments:
+ * g - the game.
+ * description:
+ * clears all the moves after the current move in the moves-log,
+ * and the checkpoints of the steps that were cleared.
+ */
+void clearNextMoves(Game *g) {
+	g->log.numMoves = g->log.curr;
+	g->log.numSteps = g->log.step;
+	g->log.numCheckpoints = g->log.step/CHECKPOINT_STEPS;
+}
 
-	for (i = 0; i < myGame.N*myGame.N; i++) {
-		if (getCellN(i)->val) {
-			getCellN(i)->demiVal = getCellN(i)->val;
+/*
+ * jumpToStep:
+ * -----------
+ * arguments:
+ * g - the game.
+ * k - a step of the moves-log (0 to g->log.numSteps).
+ * description:
+ * brings the board to the state after step 'k' (step 0 being the loaded
+ * board), in either direction. the board's values are copied from the last
+ * checkpoint at or before step 'k' (or from the snapshot of the loaded
+ * board), the values of at most CHECKPOINT_STEPS-1 steps are replayed over
+ * them, and everything derived from the values is recomputed once (recountBoard).
+ */
+void jumpToStep(Game *g, int k) {
+	MovesLog *log = &g->log;
+	int n, i, first, length, c = k/CHECKPOINT_STEPS, size = g->N*g->N;
+
+	/*start from the checkpoint*/
+	if (c == 0) {
+		for (n = 0; n < size; n++) {
+			setVal(g, n, g->initVals[n]);
+		}
+		log->curr = 0;
+	} else {
+		for (n = 0; n < size; n++) {
+			setVal(g, n, log->checkpointVals[(c - 1)*size + n]);
 		}
+		log->curr = log->checkpoints[c - 1];
 	}
 
+	/*replay the steps after it*/
+	for (log->step = c*CHECKPOINT_STEPS; log->step < k; log->step++) {
+		length = stepAt(g, log->curr, &first);
+		for (i = first; i < first + length; i++) {
+			setVal(g, moveCell(log->moves[i]), moveNewVal(log->moves[i]));
+		}
+		log->curr = first + length + (first != log->curr);
+	}
+	recountBoard(g);
 }
 
 /*
- * copyDemivalsToVals:
- * -------------------
+ * playMove:
+ * ---------
  * arguments:
- * none.
+ * g - the game.
+ * m - a move.
+ * val - the value to set: the move's new value to redo it, or its old value to undo it.
+ * old - the value the cell holds now.
  * description:
- * for every cell in board:
- *     demiVal = val.
+ * sets the cell of move 'm' to 'val', and updates the board accordingly.
  */
-void copyDemivalsToVals() {
+void playMove(Game *g, Move m, int val, int old) {
+	int n = moveCell(m);
+	setVal(g, n, val);
+	if (!(old) && (val)) {
+		g->numFilled++;
+	}
+	if ((old) && !(val)) {
+		g->numFilled--;
+	}
+	updateCellStatus(g, getCol(g, n), getRow(g, n), val, old);
+}
 
-	int i;
+/*
+ * undoAny:
+ * --------
+ * arguments:
+ * g - the game.
+ * description:
+ * reverts the current step (a move, or a group of moves) in moves-log,
+ * and updates the board and moves-log accordingly.
+ */
+void undoAny(Game *g) {
+	int first, i, length = lastStep(g, &first);
+	Move m;
+	for (i = first + length - 1; i >= first; i--) {
+		m = g->log.moves[i];
+		playMove(g, m, moveOldVal(m), moveNewVal(m));
+	}
+	g->log.curr = first - isGroupHeader(g->log.moves[g->log.curr - 1]);
+	g->log.step--;
+}
 
-	for (i = 0; i < myGame.N*myGame.N; i++) {
-		if (getCellN(i)->demiVal) {
-			getCellN(i)->val = getCellN(i)->demiVal;
-		}
+/*
+ * redoAny:
+ * --------
+ * arguments:
+ * g - the game.
+ * description:
+ * redoes a step (a move, or a group of moves).
+ * updates the board and moves-log accordingly.
+ */
+void redoAny(Game *g) {
+	int first, i, length = nextStep(g, &first);
+	Move m;
+	for (i = first; i < first + length; i++) {
+		m = g->log.moves[i];
+		playMove(g, m, moveNewVal(m), moveOldVal(m));
 	}
+	g->log.curr = first + length + isGroupHeader(g->log.moves[g->log.curr]);
+	g->log.step++;
+}
+
 
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                             5. SET                              *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * setCell:
+ * --------
+ * arguments:
+ * g - the game.
+ * col - cell's column.
+ * row - cell's row.
+ * newVal - cell's new value.
+ * description:
+ * sets cell <col,row> to value newVal.
+ * updates the moves-log (as part of the open group of moves, if
+ * there is one), and the board.
+ */
+void setCell(Game *g, int col, int row, int newVal) {
+	int n = getN(g, col, row), oldVal = getVal(g, n);
+
+	setVal(g, n, newVal);
+	addMove(g, col, row, oldVal, newVal);
+
+	/*update numFilled*/
+	if ((oldVal == 0) && (newVal != 0))
+		g->numFilled++;
+	if ((oldVal != 0) && (newVal == 0))
+		g->numFilled--;
+
+	updateCellStatus(g, col, row, newVal, oldVal);
 }
 
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                           6. GENERATE                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
 /*
- * isDemiValid:
- * ------------
+ * nextRandom:
+ * -----------
  * arguments:
- * n - the number (left to right, then top to bottom) of the cell to be checked.
+ * rng - a random state (e.g. the rng field of a game).
  * description:
- * returns 1 iff the demiVal of the n'th cell
- * is valid with regard to the demi-values of other cells.
+ * advances 'rng' and returns the next pseudo-random 32-bit number of its
+ * sequence: the state is stepped by a fixed odd number, and mixed (see
+ * mixBits), all in 32 bits, so the sequence is the same whatever the width
+ * of unsigned long. every game keeps its own state, so games used at once,
+ * by different threads, don't share one.
  */
-int isDemiValid(int n) {
+unsigned long nextRandom(unsigned long *rng) {
+	*rng = (*rng + 0x9E3779B9UL) & 0xFFFFFFFFUL;
+	return mixBits(*rng);
+}
 
-	int demiVal = getCellN(n)->demiVal;
-	int col = getCol(n);
-	int row = getRow(n);
-	int N = myGame.N;
-	int bh = myGame.blockH;
-	int bw = myGame.blockW;
-	int i, j;
+/*
+ * randInt:
+ * --------
+ * arguments:
+ * rng - a random state (see nextRandom).
+ * range - the range from which the random int will be chosen.
+ * description:
+ * returns a random integer between 0-(range-1).
+ */
+int randInt(unsigned long *rng, int range) {
+	return (int)(nextRandom(rng)%(unsigned long)range);
+}
 
-	/*check col*/
+/*
+ * shuffleCells:
+ * -------------
+ * arguments:
+ * rng - a random state (see nextRandom).
+ * perm - an array of 'size' ints.
+ * size - number of cells.
+ * k - number of positions to shuffle.
+ * description:
+ * fills 'perm' with the cell numbers 0 to size-1, and moves k cells chosen
+ * uniformly at random to its first k positions (a partial Fisher-Yates shuffle).
+ * with k = size, 'perm' is a random permutation of 0 to size-1.
+ */
+void shuffleCells(unsigned long *rng, int *perm, int size, int k) {
+	int i, j, tmp;
+	for (i = 0; i < size; i++) {
+		perm[i] = i;
+	}
+	for (i = 0; i < k; i++) {
+		j = i + randInt(rng, size - i);
+		tmp = perm[i];
+		perm[i] = perm[j];
+		perm[j] = tmp;
+	}
+}
 
-	for (i=0; i<N; i++) {
-		if (i == row) {
-			continue;
+/*
+ * tryGenerate:
+ * ------------
+ * arguments:
+ * g - the game.
+ * y - number of cells not to be erased.
+ * description:
+ * takes a random solved grid from the grid pool (see GridPool.c), which derives
+ * it from a pool grid by symmetry transforms, without running a solver.
+ * then sets Y random cells of the grid on the (empty) board.
+ * returns SudokuOk if successful, SudokuGeneratorFailed if no grid was
+ * derived, and SudokuOutOfMemory if there is not enough memory (then
+ * the board is left as it was).
+ */
+int tryGenerate(Game *g, int y) {
+	int size = g->N*g->N, i, n, result = SudokuOutOfMemory;
+	int *perm = malloc(size*sizeof(int));
+	int *grid = malloc(size*sizeof(int));
+	char *keep = calloc(size, sizeof(char));
+
+	if (perm && grid && keep && reserveMoves(g, y + 2)) {
+		result = deriveGrid(g, grid);
+	}
+
+	/*choose Y cells to preserve (a partial Fisher-Yates shuffle), and set them in order.
+	 *with no cell to set, no group is opened, so the moves that can be redone are kept:*/
+	if (result == SudokuOk && y > 0) {
+		shuffleCells(&g->rng, perm, size, y);
+		for (i = 0; i < y; i++) {
+			keep[perm[i]] = 1;
 		}
-		if (getCell(col, i)->demiVal == demiVal) {
-			return 0;
+		beginMoveGroup(g);
+		for (n = 0; n < size; n++) {
+			if (keep[n]) {
+				setCell(g, getCol(g, n), getRow(g, n), grid[n]);
+			}
 		}
+		endMoveGroup(g);
 	}
 
-	/*check row*/
+	free(perm);
+	free(grid);
+	free(keep);
+	return result;
+}
 
-	for (i=0; i<N; i++) {
-		if (i == col) {
-			continue;
+/*
+ * tryGenerateUnique:
+ * ------------------
+ * arguments:
+ * g - the game.
+ * target - the number of clues to stop at (0 for a minimal puzzle).
+ * clues - set to the number of clues set.
+ * description:
+ * takes a random full grid from the grid pool (as in tryGenerate), removes its clues in
+ * random order as long as the solution stays unique (see removeClues),
+ * and sets the remaining clues on the (empty) board.
+ * returns SudokuOk if successful, SudokuNotMinimal if the puzzle was set but
+ * a uniqueness check was given up before the target was reached (so it may
+ * not be minimal), SudokuGeneratorFailed if no grid was derived, and
+ * SudokuOutOfMemory if there is not enough memory (then the board is left
+ * as it was).
+ */
+int tryGenerateUnique(Game *g, int target, int *clues) {
+	int size = g->N*g->N, n, minimal, result = SudokuOutOfMemory;
+	int *perm = malloc(size*sizeof(int));
+	int *grid = malloc(size*sizeof(int));
+	SolverState s;
+
+	if (!createSolver(&s, g->blockW, g->blockH)) {
+		free(perm);
+		free(grid);
+		return SudokuOutOfMemory;
+	}
+	if (perm && grid) {
+		result = deriveGrid(g, grid);
+	}
+	if (result == SudokuOk) {
+		for (n = 0; n < size; n++) {
+			setSolverValue(&s, n, grid[n]);
 		}
-		if (getCell(i, row)->demiVal == demiVal) {
-			return 0;
+		shuffleCells(&g->rng, perm, size, size);
+		*clues = removeClues(&s, perm, target, &minimal);
+		if (*clues < 0 || !reserveMoves(g, *clues + 2)) {
+			result = SudokuOutOfMemory;
 		}
 	}
 
-	/*check block*/
-
-	for (i = col - col%bw; i < col - col%bw + bw; i++) {
-		for (j = row - row%bh; j < row - row%bh + bh; j++) {
-			if (i == col && j == row) {
-				continue;
-			}
-			if (getCell(i, j)->demiVal == demiVal) {
-				return 0;
+	/*set the clues in order, as a single move (none if no clue is left):*/
+	if (result == SudokuOk && *clues > 0) {
+		beginMoveGroup(g);
+		for (n = 0; n < size; n++) {
+			if (s.vals[n]) {
+				setCell(g, getCol(g, n), getRow(g, n), s.vals[n]);
 			}
 		}
+		endMoveGroup(g);
+	}
+	if (result == SudokuOk && !minimal && *clues > target) {
+		result = SudokuNotMinimal;
 	}
 
+	freeSolver(&s);
+	free(perm);
+	free(grid);
+	return result;
+}
+
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                         7. DEMI-VALUES                          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
-	return 1;
+
+/*
+ * clearDemiVals:
+ * --------------
+ * arguments:
+ * g - the game.
+ * i - the number (left to right, then top to bottom) of the cell that all
+ * cells with number greater than it, will be cleared.
+ * description:
+ * clears the demiVals of all cells with index
+ * greater than i.
+ */
+void clearDemiVals(Game *g, int i) {
+
+	for (; i < g->N*g->N; i++) {
+		setDemiVal(g, i, 0);
+	}
 
 }
 
+/*
+ * copyDemivalsToVals:
+ * -------------------
+ * arguments:
+ * g - the game.
+ * description:
+ * for every cell in board:
+ *     demiVal = val.
+ */
+void copyDemivalsToVals(Game *g) {
+
+	int i;
+
+	for (i = 0; i < g->N*g->N; i++) {
+		if (getDemiVal(g, i)) {
+			setVal(g, i, getDemiVal(g, i));
+		}
+	}
+
+}
+
+
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- *                          10. AUTOFILL                           *
+ *                           8. AUTOFILL                           *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 
@@ -1076,225 +1531,324 @@ int isDemiValid(int n) {
  * getCellSingleValue:
  * -------------------
  * arguments:
+ * g - the game.
  * index - the number (left to right, then top to bottom) of the cell to be evaluated.
  * description:
- * if there is a single legal value for the n'th cell:
+ * if there is a single legal value for the (empty) n'th cell:
  *     return that value.
  * else:
  *     return 0.
  */
-int getCellSingleValue(int index) {
-	int col = getCol(index);
-	int row = getRow(index);
-	int N = myGame.N;
-	int bh = myGame.blockH;
-	int bw = myGame.blockW;
-	int val;
-	int counter = 0;
-	int result;
-	int i, j;
-
-	/*count no. of legal vals:*/
+int getCellSingleValue(Game *g, int index) {
+	return singleValue(getCandidates(g, getCol(g, index), getRow(g, index)));
+}
 
-	for (val = 1; val <= N; val++) {
+/*
+ * singleValue:
+ * ------------
+ * arguments:
+ * candidates - a candidates mask (see getCandidates).
+ * description:
+ * if 'candidates' holds a single value:
+ *     return that value.
+ * else:
+ *     return 0.
+ */
+int singleValue(unsigned int candidates) {
+	/*if only 1 legal value, return it. else return 0 */
+	if (candidates == 0 || (candidates & (candidates - 1))) {
+		return 0;
+	}
+	return lowestBitIndex(candidates) + 1;
+}
 
-		/*check col*/
 
-		for (i=0; i<N; i++) {
-			if (i == row) {
+/*
+ * dropFromPeers:
+ * --------------
+ * arguments:
+ * g - the game.
+ * n - the number (left to right, then top to bottom) of a cell that was just set.
+ * val - the value the n'th cell was set to.
+ * cands - the candidates mask of every cell (0 for filled cells).
+ * queue - the worklist of cells with a single candidate.
+ * tail - the number of cells pushed to 'queue' so far.
+ * description:
+ * removes 'val' from the candidates of the empty cells in the row, column
+ * and block of the n'th cell, and pushes every cell left with a single
+ * candidate to 'queue'. a cell is pushed once, when its candidates drop
+ * from several to one, so 'queue' never holds more than N*N cells.
+ * returns the new number of cells pushed to 'queue'.
+ */
+int dropFromPeers(Game *g, int n, int val, unsigned int *cands, int *queue, int tail) {
+	int i, j, peer, units[3];
+	unsigned int bit = valueBit(val);
+
+	cellUnits(g, getCol(g, n), getRow(g, n), units);
+	for (i = 0; i < 3; i++) {
+		for (j = 0; j < g->N; j++) {
+			peer = unitCell(g, units[i], j);
+			if (!(cands[peer] & bit)) {
 				continue;
 			}
-			if (getCell(col, i)->val == val) {
-				goto INVALID;
+			cands[peer] &= ~bit;
+			if (singleValue(cands[peer])) {
+				queue[tail++] = peer;
 			}
 		}
+	}
+	return tail;
+}
 
-		/*check row*/
-
-		for (i=0; i<N; i++) {
-			if (i == col) {
+/*
+ * fillSingles:
+ * ------------
+ * arguments:
+ * g - the game.
+ * cells - an array of N*N numbers, filled with the cells set.
+ * description:
+ * sets every empty cell that has a single legal value to that value (a
+ * single pass, so two cells of a unit may get the same value). the
+ * candidates are computed a row at a time, before any cell is set. all the
+ * cells set are recorded as a group of moves; if none is set, nothing is
+ * recorded, so the moves that can be redone are kept.
+ * returns the number of cells set (in 'cells', in ascending order), or -1 if
+ * there is not enough memory for the moves-log.
+ */
+int fillSingles(Game *g, int *cells) {
+	int N = g->N, n, i, val, row, col, count = 0;
+	unsigned int cands[UNIT_PAD];
+
+	/*save the single value of every empty cell as its demiVal*/
+	clearDemiVals(g, 0);
+	for (row = 0; row < N; row++) {
+		unitCandidates(g, row, cands);
+		for (col = 0; col < N; col++) {
+			n = getN(g, col, row);
+			if (getVal(g, n)) {
 				continue;
 			}
-			if (getCell(i, row)->val == val) {
-				goto INVALID;
+			val = singleValue(cands[col]);
+			if (val) {
+				setDemiVal(g, n, val);
+				cells[count++] = n;
 			}
 		}
+	}
+	if (count == 0) {
+		return 0;
+	}
 
-		/*check block*/
+	/*set the cells to their demiVals*/
+	if (!reserveMoves(g, N*N + 2)) {
+		return -1;
+	}
+	beginMoveGroup(g);
+	for (i = 0; i < count; i++) {
+		n = cells[i];
+		setCell(g, getCol(g, n), getRow(g, n), getDemiVal(g, n));
+	}
+	endMoveGroup(g);
+	return count;
+}
+
+/*
+ * fillAllSingles:
+ * ---------------
+ * arguments:
+ * g - the game.
+ * cells - an array of N*N numbers, filled with the cells set.
+ * description:
+ * sets cells that have a single legal value, until no such cell is left.
+ * the candidates of all cells are computed once. every cell set removes its
+ * value from its peers' candidates, and the peers left with a single option
+ * are pushed to a worklist (dropFromPeers), so no cell is evaluated twice for
+ * nothing. a cell whose last option was taken by a peer is left empty.
+ * all the cells set are recorded as a group of moves; if none is set,
+ * nothing is recorded.
+ * returns the number of cells set (in 'cells', in the order they were set),
+ * or -1 if there is not enough memory (the board is then left as it was).
+ */
+int fillAllSingles(Game *g, int *cells) {
+	int N = g->N, n, val, row, col, head = 0, tail = 0, count = 0;
+	unsigned int rowCands[UNIT_PAD];
+	unsigned int *cands;
+	int *queue;
+
+	cands = malloc(N*N*sizeof(unsigned int));
+	queue = malloc(N*N*sizeof(int));
+	if (cands == NULL || queue == NULL) {
+		free(cands);
+		free(queue);
+		return -1;
+	}
 
-		for (i = col - col%bw; i < col - col%bw + bw; i++) {
-			for (j = row - row%bh; j < row - row%bh + bh; j++) {
-				if (i == col && j == row) {
-					continue;
-				}
-				if (getCell(i, j)->val == val) {
-					goto INVALID;
-				}
+	/*compute the candidates of the empty cells once, a row at a time, and queue the forced ones*/
+	for (row = 0; row < N; row++) {
+		unitCandidates(g, row, rowCands);
+		for (col = 0; col < N; col++) {
+			n = getN(g, col, row);
+			cands[n] = getVal(g, n) ? 0 : rowCands[col];
+			if (singleValue(cands[n])) {
+				queue[tail++] = n;
 			}
 		}
+	}
 
-		counter++;
-		result = val;
-
-		INVALID:
-		continue;}
-	/*if only 1 legal value, return it. else return 0 */
-	if (counter == 1) {
-		return result;}
-	return 0;}
-
+	/*set the forced cells, until the worklist is empty. every cell is set at most once*/
+	if (tail > 0) {
+		if (!reserveMoves(g, N*N + 2)) {
+			free(cands);
+			free(queue);
+			return -1;
+		}
+		beginMoveGroup(g);
+		while (head < tail) {
+			n = queue[head++];
+			val = singleValue(cands[n]);
+			if (val == 0) {
+				continue;
+			}
+			cands[n] = 0;
+			setCell(g, getCol(g, n), getRow(g, n), val);
+			cells[count++] = n;
+			tail = dropFromPeers(g, n, val, cands, queue, tail);
+		}
+		endMoveGroup(g);
+	}
+	free(cands);
+	free(queue);
+	return count;
+}
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- *                           11. PRINTS                            *
+ *                          9. SOLUTIONS                           *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 
 /*
- * printUndo:
- * ----------
+ * boardUniqueness:
+ * ----------------
  * arguments:
- * move - the move to be printed.
+ * g - the game.
  * description:
- * prints a message to the user, following an undo command.
+ * returns 0 if the board has no solution, 1 if it has a unique solution,
+ * and 2 if it has more than one, or -1 if there is not enough memory to
+ * search. the search stops as soon as a second solution is found. the board
+ * is reduced by constraint propagation before the search. assumes the
+ * board isn't erroneous.
  */
-void printUndo (MovesList *move) {
-	char x, y, z1, z2;
-	x = move->col + 49;
-	y = move->row + 49;
-	z1 = move->newVal + 48;
-	z2 = move->oldVal + 48;
-	if (z1 == '0') z1 = '_';
-	if (z2 == '0') z2 = '_';
-	printf("Undo %c,%c: from %c to %c\n", x, y, z1, z2);
+int boardUniqueness(Game *g) {
+	SolverState s;
+	int result = 0;
+	if (!createSolver(&s, g->blockW, g->blockH)) {
+		return -1;
+	}
+	if (loadSolverFromGame(g, &s) && propagate(&s)) {
+		result = classifySolutions(&s);
+	}
+	freeSolver(&s);
+	return result;
 }
 
 /*
- * printRedo:
- * ----------
+ * hasDeadCell:
+ * ------------
  * arguments:
- * move - the move to be printed.
+ * g - the game.
  * description:
- * prints a message to the user, following an redo command.
+ * returns 1 if some empty cell has no legal value (so the board is
+ * unsolvable), 0 otherwise. the board is scanned a row at a time
+ * with the unit kernels.
  */
-void printRedo (MovesList *move) {
-	char x, y, z1, z2;
-	x = move->col + 49;
-	y = move->row + 49;
-	z1 = move->oldVal + 48;
-	z2 = move->newVal + 48;
-	if (z1 == '0') z1 = '_';
-	if (z2 == '0') z2 = '_';
-	printf("Redo %c,%c: from %c to %c\n", x, y, z1, z2);
-}
-
-/*
- * printCell:
- * ----------
- * arguments:
- * x - column of the cell
- * y - row of the cell.
- * description:
- * prints the cell <x,y> in the requested format
- */
-void printCell(int x, int y) {
-	int f = 0;
-	Cell * pcell;
-	pcell = myGame.board + getN(x, y);
-	printf(" ");
-	if (pcell->val == 0) printf("  ");
-	else printf("%2d", pcell->val);
-	if (pcell->isFixed == 1) {
-		printf(".");
-		f = 1;
-	}
-	else{
-		if ((myGame.mode ==  Edit) || myGame.markErrors == 1){
-			if (pcell->isError == 1) {
-				printf("*");
-				f = 1;
+int hasDeadCell(Game *g) {
+	unsigned int cands[UNIT_PAD], empty;
+	int row;
+	for (row = 0; row < g->N; row++) {
+		empty = unitMatches(g, row, 0);
+		if (!empty) {
+			continue;
+		}
+		unitCandidates(g, row, cands);
+		for (; empty; empty &= empty - 1) {
+			if (!cands[lowestBitIndex(empty)]) {
+				return 1;
 			}
 		}
 	}
-	if (f==0) printf(" ");
-
+	return 0;
 }
 
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                         10. BOARD HASH                          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
 /*
- * printSeparatorRow:
- * ------------------
+ * mixBits:
+ * --------
  * arguments:
- * none.
+ * x - a number of at most 32 bits.
  * description:
- * prints a separator row in the requested format.
+ * returns a pseudo-random 32-bit number mixed from x. different numbers are
+ * mixed to different numbers. every product is masked to 32 bits, so the
+ * result is the same whether unsigned long has 32 bits or more.
  */
-void printSeparatorRow () {
-	int i, n = myGame.blockH, m = myGame.blockW;
-	for (i=0; i<(4*n*m + n); i++)
-		printf("-");
-	printf("-\n");
+unsigned long mixBits(unsigned long x) {
+	x ^= x >> 16;
+	x = (x*0x7FEB352DUL) & 0xFFFFFFFFUL;
+	x ^= x >> 15;
+	x = (x*0x846CA68BUL) & 0xFFFFFFFFUL;
+	return x ^ (x >> 16);
 }
 
 /*
- * printRow:
- * ---------
+ * zobristKey:
+ * -----------
  * arguments:
- * r - number of the row.
+ * n - the number (left to right, then top to bottom) of a cell.
+ * val - a cell value (0 for empty).
+ * half - 1 for the high 32 bits of the key, 0 for the low 32 bits.
  * description:
- * prints a row (filled with cells) in the requested format.
+ * returns a half of the Zobrist key of the n'th cell holding 'val', a fixed
+ * pseudo-random 64-bit number (0 for an empty cell). the halves are mixed
+ * from n, val and 'half' (see mixBits), so they need no table, are the same
+ * in every run, and no two keys are equal.
  */
-void printRow(int r) {
-	int j;
-	for (j=0; j<myGame.N; j++){
-		if ((j%myGame.blockW) == 0)
-			printf("|");
-		printCell(j,r);
+unsigned long zobristKey(int n, int val, int half) {
+	if (!val) {
+		return 0;
 	}
-	printf("|\n");
+	return mixBits((unsigned long)n << 6 | (unsigned long)val << 1 | (unsigned long)half);
 }
 
 /*
- * printgb:
- * ---------
+ * toggleKey:
+ * ----------
  * arguments:
- * none.
+ * h - a board hash.
+ * n - the number of a cell.
+ * val - a cell value (0 for empty).
  * description:
- * prints the game board according to the requested print format.
+ * XORs the Zobrist key of the n'th cell holding 'val' into 'h', which adds
+ * the value to the hashed board, or removes it if it is there.
  */
-void printgb() {
-	int i;
-	for (i=0; i<myGame.N; i++){
-		if ((i%myGame.blockH) == 0)
-			printSeparatorRow();
-		printRow(i);
-	}
-	printSeparatorRow();
+void toggleKey(BoardHash *h, int n, int val) {
+	h->hi ^= zobristKey(n, val, 1);
+	h->lo ^= zobristKey(n, val, 0);
 }
 
-
-/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- *                      12. MEMORY ALLOCATION                      *
- * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
-
-
 /*
- * safealloc:
- * ---------
+ * boardHash:
+ * ----------
  * arguments:
- * size - size of the memory to be allocated.
+ * g - the game.
  * description:
- * attempts to allocate memory of the requested size.
- * if allocation was successful, return a pointer to the memory address.
- * if allocation fails, tries again. if failed twice,
- * prints an error message and closes the program.
+ * returns the Zobrist hash of the values on the board of g: the XOR of the
+ * keys of all the filled cells. it is kept up to date by updateCellStatus,
+ * so two boards of the same size are (almost surely) equal iff their hashes are.
  */
-void * safealloc(int size) {
-	void *p = malloc(size);
-	if (p == NULL) {
-		p = malloc(size);
-		if (p==NULL) {
-			printf("Fatal error: memory allocation failed\n");
-			exitGame();
-		}
-	}
-	return p;
+BoardHash boardHash(Game *g) {
+	return g->hash;
 }
@@ -13,51 +13,79 @@
 #include <stdio.h>
 #include "DataStructures.h"
 
-int isNum(char *st);
-void checkIfError(int col, int row, int val, int old);
-void isErrorUpdate(int col,int row,int old);
-int isErroneous();
+void cellUnits(Game *g, int col, int row, int *units);
+int isConflicting(Game *g, int col, int row, int val);
+int otherHolder(Game *g, int unit, int val, int col, int row);
+void removeFromUnits(Game *g, int col, int row, int old);
+void addToUnits(Game *g, int col, int row, int val);
+void setErrorStatus(Game *g, int n, int isError);
+int lowestBitIndex(unsigned int mask);
+unsigned int valueBit(int val);
+void recountBoard(Game *g);
+void updateCellStatus(Game *g, int col, int row, int val, int old);
+unsigned int getCandidates(Game *g, int col, int row);
+int isErroneous(Game *g);
 int readSize(FILE *ifp);
-void readNextCell(FILE *ifp, Cell *cell);
+int readNextCell(FILE *ifp, int N, int *val, int *fixed);
 int writeSize(FILE *ifp, int height, int width);
-int writeCell(FILE *ifp, Cell *cell, int val);
-int getRow(int n);
-int getCol(int n);
-int getN(int col, int row);
-Cell* getCell(int col, int row);
-Cell* getCellN(int n);
-void setCell(int col, int row, int newVal, int user);
-void addMove(int col, int row, int oldVal, int newVal, int user);
-void printMovesList(void);
-void clearNextMoves(void);
-void createMovesList1(void);
-void createGame(int blockW, int blockH, enum Mode m);
-MovesList* createMove(int col, int row, int oldVal, int newVal, int user);
-void undoAny(void);
-void redoAny(void);
-int randInt(int range);
-int tryGenerate(int x, int y);
-void clearDemiVals(int i);
-int isDemiValid(int n);
-void copyValsToDemivals();
-void copyDemivalsToVals();
-int getCellSingleValue(int index);
-void printDemiBoard();
-void printStack(Elem *e, Stack *st);
-void printUndo (MovesList *move);
-void printRedo (MovesList *move);
-Elem *createElem(int cellIndex);
-int push (Stack *st, int cellIndex);
-Elem *pop(Stack *st);
-int writeCellEndOfLine(FILE *ifp, Cell *cell, int val);
-int hasNewLine(char input[]);
-int nextEmptyCell(int i);
-void printCell(int x, int y);
-void printSeparatorRow (void);
-void printRow(int r);
-void printgb(void);
-int parseMarkErrorInput(char * token);
-void * safealloc(int size);
+int writeCell(Game *g, FILE *ifp, int n, int val);
+int getRow(Game *g, int n);
+int getCol(Game *g, int n);
+int getN(Game *g, int col, int row);
+int getBlock(Game *g, int col, int row);
+int getVal(Game *g, int n);
+void setVal(Game *g, int n, int val);
+int getDemiVal(Game *g, int n);
+void setDemiVal(Game *g, int n, int val);
+int isFixedCell(Game *g, int n);
+void setFixedCell(Game *g, int n, int isFixed);
+int isErrorCell(Game *g, int n);
+void setCell(Game *g, int col, int row, int newVal);
+Move packMove(int n, int oldVal, int newVal);
+int moveCell(Move m);
+int moveOldVal(Move m);
+int moveNewVal(Move m);
+int isGroupHeader(Move m);
+void appendRecord(Game *g, Move m);
+int reserveMoves(Game *g, int numRecords);
+void saveCheckpoint(Game *g);
+void stepDone(Game *g);
+void addMove(Game *g, int col, int row, int oldVal, int newVal);
+void beginMoveGroup(Game *g);
+void endMoveGroup(Game *g);
+int stepAt(Game *g, int record, int *first);
+int lastStep(Game *g, int *first);
+int nextStep(Game *g, int *first);
+void jumpToStep(Game *g, int k);
+void playMove(Game *g, Move m, int val, int old);
+void clearNextMoves(Game *g);
+void initGame(Game *g);
+void seedGame(Game *g, unsigned long seed);
+void freeGame(Game *g);
+int createGame(Game *g, int blockW, int blockH, enum Mode m);
+void takeSnapshot(Game *g);
+void restoreSnapshot(Game *g);
+void undoAny(Game *g);
+void redoAny(Game *g);
+unsigned long nextRandom(unsigned long *rng);
+int randInt(unsigned long *rng, int range);
+void shuffleCells(unsigned long *rng, int *perm, int size, int k);
+int tryGenerate(Game *g, int y);
+int tryGenerateUnique(Game *g, int target, int *clues);
+void clearDemiVals(Game *g, int i);
+void copyDemivalsToVals(Game *g);
+int getCellSingleValue(Game *g, int index);
+int singleValue(unsigned int candidates);
+int dropFromPeers(Game *g, int n, int val, unsigned int *cands, int *queue, int tail);
+int fillSingles(Game *g, int *cells);
+int fillAllSingles(Game *g, int *cells);
+int writeCellEndOfLine(Game *g, FILE *ifp, int n, int val);
+int boardUniqueness(Game *g);
+int hasDeadCell(Game *g);
+unsigned long mixBits(unsigned long x);
+unsigned long zobristKey(int n, int val, int half);
+void toggleKey(BoardHash *h, int n, int val);
+BoardHash boardHash(Game *g);
 
 #endif /* AUXMETHODS_H_ */
 
@@ -0,0 +1,346 @@
+/*
+ * Batch.c
+ *
+ * this file implements the batch mode, which solves a file of puzzles
+ * without the interactive game loop:
+ *     sudoku-console --batch in.txt [--out out.txt] [-j N]
+ * every line of the input holds one puzzle of N*N characters, listed left to
+ * right, then top to bottom. a value is written as '1'-'9', and values above 9
+ * as 'A'-'Z', so 16x16 puzzles use 1-9A-G and 25x25 puzzles use 1-9A-P.
+ * '0' and '.' mark empty cells. N must be 4, 9, 16 or 25 (square blocks).
+ * for every input line, one line is written to the output, in input order:
+ * the solution in the same format, "unsolvable", or "invalid" for a line that
+ * is not a puzzle.
+ * the input is streamed in chunks of lines. a pool of worker threads solves
+ * every chunk, each worker with its own SolverState, while the main thread
+ * reads the input and writes the output. myGame is never used.
+ * contents:
+ * 1. puzzle line functions. (private)
+ * 2. thread pool functions. (private)
+ * 3. batch function - batchSolve. (public)
+ *
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "DataStructures.h"
+#include "AuxMethods.h"
+#include "Console.h"
+#include "Solver.h"
+#include "Propagation.h"
+#include "Batch.h"
+
+#define BATCH_CHUNK 4096 /*number of lines solved between two writes*/
+#define BATCH_LINE 1024 /*maximal length of a line, enough for 25x25 puzzles*/
+
+/*
+ * BatchPool:
+ * ----------
+ * the worker threads, and the chunk of lines they are working on.
+ */
+typedef struct
+{
+	pthread_mutex_t lock; /*guards all the fields below*/
+	pthread_cond_t
+		work, /*signalled when a new chunk is ready, or the pool is closing*/
+		done; /*signalled when every line of the chunk was solved*/
+	int
+		numLines, /*lines in the current chunk*/
+		next, /*the next line to take*/
+		finished, /*lines solved*/
+		closing; /*set when there are no more chunks*/
+	char
+		*lines, /*line i is at lines + i*BATCH_LINE*/
+		*results; /*result i is at results + i*BATCH_LINE*/
+} BatchPool;
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                        1. PUZZLE LINES                          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * charToValue:
+ * ------------
+ * arguments:
+ * c - a character of a puzzle line.
+ * description:
+ * returns the value 'c' represents (0 for an empty cell), or -1 if it isn't a value.
+ */
+int charToValue(char c) {
+	if (c == '.' || c == '0') {
+		return 0;
+	}
+	if (c >= '1' && c <= '9') {
+		return c - '0';
+	}
+	if (c >= 'A' && c <= 'Z') {
+		return c - 'A' + 10;
+	}
+	if (c >= 'a' && c <= 'z') {
+		return c - 'a' + 10;
+	}
+	return -1;
+}
+
+/*
+ * valueToChar:
+ * ------------
+ * arguments:
+ * val - a cell value (1 to 25).
+ * description:
+ * returns the character representing 'val' in a puzzle line.
+ */
+char valueToChar(int val) {
+	if (val < 10) {
+		return '0' + val;
+	}
+	return 'A' + val - 10;
+}
+
+/*
+ * lineBlockSize:
+ * --------------
+ * arguments:
+ * line - a puzzle line, without its line break.
+ * description:
+ * returns the block size (2 to 5) of the puzzle in 'line',
+ * or 0 if its length isn't that of a puzzle.
+ */
+int lineBlockSize(char *line) {
+	int b, len = strlen(line);
+	for (b = 2; b <= 5; b++) {
+		if (len == b*b*b*b) {
+			return b;
+		}
+	}
+	return 0;
+}
+
+/*
+ * solveLine:
+ * ----------
+ * arguments:
+ * s - the worker's state, created for blocks of size b (or with N = 0).
+ * line - a puzzle line, without its line break.
+ * result - a buffer of BATCH_LINE chars to write the result into.
+ * description:
+ * solves the puzzle in 'line', and writes its solution, "unsolvable"
+ * or "invalid" into 'result'. 's' is recreated if the puzzle's size
+ * is different.
+ */
+void solveLine(SolverState *s, char *line, char *result) {
+	int n, val, b = lineBlockSize(line);
+
+	if (!b) {
+		strcpy(result, "invalid");
+		return;
+	}
+	if (s->N != b*b) {
+		if (s->N) {
+			freeSolver(s);
+		}
+		if (!createSolver(s, b, b)) {
+			memoryError();
+		}
+	}
+
+	/*load the clues. a clue that clashes with another makes the puzzle unsolvable*/
+	clearSolver(s);
+	for (n = 0; n < s->N*s->N; n++) {
+		val = charToValue(line[n]);
+		if (val < 0 || val > s->N) {
+			strcpy(result, "invalid");
+			return;
+		}
+		if (val && !setSolverValue(s, n, val)) {
+			strcpy(result, "unsolvable");
+			return;
+		}
+	}
+
+	if (!propagate(s) || !findSolution(s)) {
+		strcpy(result, "unsolvable");
+		return;
+	}
+	for (n = 0; n < s->N*s->N; n++) {
+		result[n] = valueToChar(s->vals[n]);
+	}
+	result[n] = '\0';
+}
+
+/*
+ * readLine:
+ * ---------
+ * arguments:
+ * ifp - the input file.
+ * line - a buffer of BATCH_LINE chars.
+ * description:
+ * reads the next line of 'ifp' into 'line', without its line break.
+ * a line that is too long is cut, and the rest of it is skipped.
+ * returns 0 at the end of the file, 1 otherwise.
+ */
+int readLine(FILE *ifp, char *line) {
+	int len, c;
+	if (fgets(line, BATCH_LINE, ifp) == NULL) {
+		return 0;
+	}
+	len = strlen(line);
+	if (len > 0 && line[len - 1] == '\n') {
+		line[--len] = '\0';
+	} else {
+		while ((c = fgetc(ifp)) != EOF && c != '\n') {
+			line[0] = '\0'; /*too long to be a puzzle*/
+		}
+	}
+	if (len > 0 && line[len - 1] == '\r') {
+		line[len - 1] = '\0';
+	}
+	return 1;
+}
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                         2. THREAD POOL                          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * runBatchWorker:
+ * ---------------
+ * arguments:
+ * arg - the BatchPool.
+ * description:
+ * solves lines of the current chunk until it is taken, then waits for
+ * the next chunk, until the pool is closing.
+ */
+void *runBatchWorker(void *arg) {
+	BatchPool *pool = arg;
+	SolverState s;
+	int i;
+
+	s.N = 0;
+	pthread_mutex_lock(&pool->lock);
+	while (1) {
+		while (!pool->closing && pool->next >= pool->numLines) {
+			pthread_cond_wait(&pool->work, &pool->lock);
+		}
+		if (pool->next >= pool->numLines) { /*closing, and nothing left*/
+			break;
+		}
+		i = pool->next++;
+		pthread_mutex_unlock(&pool->lock);
+
+		solveLine(&s, pool->lines + i*BATCH_LINE, pool->results + i*BATCH_LINE);
+
+		pthread_mutex_lock(&pool->lock);
+		if (++pool->finished == pool->numLines) {
+			pthread_cond_signal(&pool->done);
+		}
+	}
+	pthread_mutex_unlock(&pool->lock);
+
+	if (s.N) {
+		freeSolver(&s);
+	}
+	return NULL;
+}
+
+/*
+ * solveChunk:
+ * -----------
+ * arguments:
+ * pool - the pool, with no chunk in progress.
+ * numLines - the number of lines read into pool->lines.
+ * description:
+ * hands the lines to the workers, and waits until all of them are solved.
+ */
+void solveChunk(BatchPool *pool, int numLines) {
+	pthread_mutex_lock(&pool->lock);
+	pool->numLines = numLines;
+	pool->next = 0;
+	pool->finished = 0;
+	pthread_cond_broadcast(&pool->work);
+	while (pool->finished < pool->numLines) {
+		pthread_cond_wait(&pool->done, &pool->lock);
+	}
+	pthread_mutex_unlock(&pool->lock);
+}
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                        3. BATCH FUNCTION                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * batchSolve:
+ * -----------
+ * arguments:
+ * ifp - the file of puzzles, one per line.
+ * ofp - the file to write the results to, one per line, in input order.
+ * numThreads - the number of worker threads (1 to MAX_THREADS).
+ * started - set to the number of worker threads that were started.
+ * description:
+ * solves every puzzle in 'ifp' (see the format above), using a pool of
+ * 'numThreads' worker threads. does not use myGame.
+ * if some of the threads can't be started, the others do their work.
+ * returns the number of lines processed, or -1 if no worker could be started.
+ */
+long batchSolve(FILE *ifp, FILE *ofp, int numThreads, int *started) {
+	BatchPool pool;
+	pthread_t *threads = safealloc(numThreads*sizeof(pthread_t));
+	int i, numLines;
+	long total = 0;
+
+	pthread_mutex_init(&pool.lock, NULL);
+	pthread_cond_init(&pool.work, NULL);
+	pthread_cond_init(&pool.done, NULL);
+	pool.numLines = pool.next = pool.finished = pool.closing = 0;
+	pool.lines = safealloc(BATCH_CHUNK*BATCH_LINE);
+	pool.results = safealloc(BATCH_CHUNK*BATCH_LINE);
+
+	*started = 0;
+	for (i = 0; i < numThreads; i++) {
+		if (!pthread_create(&threads[*started], NULL, runBatchWorker, &pool)) {
+			(*started)++;
+		}
+	}
+
+	/*read a chunk, solve it, write it, until the input ends*/
+	while (*started) {
+		numLines = 0;
+		while (numLines < BATCH_CHUNK && readLine(ifp, pool.lines + numLines*BATCH_LINE)) {
+			numLines++;
+		}
+		if (numLines == 0) {
+			break;
+		}
+		solveChunk(&pool, numLines);
+		for (i = 0; i < numLines; i++) {
+			fprintf(ofp, "%s\n", pool.results + i*BATCH_LINE);
+		}
+		total += numLines;
+	}
+
+	/*close the pool*/
+	pthread_mutex_lock(&pool.lock);
+	pool.closing = 1;
+	pthread_cond_broadcast(&pool.work);
+	pthread_mutex_unlock(&pool.lock);
+	for (i = 0; i < *started; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	pthread_cond_destroy(&pool.work);
+	pthread_cond_destroy(&pool.done);
+	pthread_mutex_destroy(&pool.lock);
+	free(pool.lines);
+	free(pool.results);
+	free(threads);
+	return *started ? total : -1;
+}
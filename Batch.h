@@ -0,0 +1,14 @@
+/*
+ * Batch.h
+ *
+ * this file allows other modules to use the batch mode.
+ */
+
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include <stdio.h>
+
+long batchSolve(FILE *ifp, FILE *ofp, int numThreads, int *started);
+
+#endif /* BATCH_H_ */
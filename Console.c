@@ -0,0 +1,298 @@
+/*
+ * Console.c
+ *
+ * this file contains the functions that read the user's commands and print
+ * the board and messages to the user. they are used by the console only
+ * (Game.c and Parser.c), and are not part of the engine (libsudoku), which
+ * prints nothing.
+ * contents:
+ * 1. parser related functions.
+ * 2. prints related functions.
+ * 3. memory allocation related functions.
+ *
+ */
+
+#include "DataStructures.h"
+#include "AuxMethods.h"
+#include "Console.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                          1. PARSER                              *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * isNum:
+ * ------
+ * arguments:
+ * st - string to be evaluated.
+ * description:
+ * if st represents an integer:
+ * 	   returns true.
+ * else:
+ *     returns false.
+ */
+int isNum(char *st){
+	int i = 0;
+	char c = st[i];
+	while(c!='\0')
+	{
+		if (((int)c<48) || ((int)c>57))
+			return 0;
+		i++;
+		c = st[i];
+	}
+	return 1;
+}
+
+/*
+ * hasNewLine:
+ * -----------
+ * arguments:
+ * input - string to be evaluated.
+ * description:
+ * if input[] contains new-line or EOF:
+ *     returns true.
+ * else:
+ *     returns false.
+ */
+int hasNewLine(char input[]) {
+	int counter = 0;
+	while (counter < 256) {
+		if (input[counter] == 10 || feof(stdin)) {
+			return 1;
+		}
+		counter++;
+	}
+	return 0;
+}
+
+/* parseMarkErrorInput:
+ * --------------------
+ * arguments:
+ * token - string to be parsed.
+ * description:
+ * an implementation of a deterministic finite automata
+ * to determine whether the int value of input is 1 (returns 1),
+ * 0 (returns 0) or neither (returns -1).
+ */
+int parseMarkErrorInput(char * token) {
+	int state = 0, mark, i = 0;
+	while (1) {
+		if (state == 0) { /*state 0 is the starting state*/
+			if (token[i] == '0') {
+				state = 1;
+				i++;
+				continue;
+			}
+			if (token[i] == '1') {
+				state = 2;
+				i++;
+				continue;
+			}
+			mark = -1;
+			break;
+		}
+		if (state == 1) { /*state 1 means input so far is "0*" */
+			if (token[i] == '0') {
+				i++;
+				continue;
+			}
+			if (token[i] == '1') {
+				state = 2;
+				i++;
+				continue;
+			}
+			if (token[i] == 0) {
+				mark = 0;
+				break;
+			}
+			mark = -1;
+			break;
+		}
+		if (state == 2) { /*state 2 means input so far is "0*1" */
+			if (token[i] == 0) {
+				mark = 1;
+				break;
+			}
+			mark = -1;
+			break;
+		}
+	}
+	return mark;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                            2. PRINTS                            *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * printUndo:
+ * ----------
+ * arguments:
+ * g - the game.
+ * move - the move to be printed.
+ * description:
+ * prints a message to the user, following an undo command.
+ */
+void printUndo (Game *g, Move move) {
+	char x, y, z1, z2;
+	x = getCol(g, moveCell(move)) + 49;
+	y = getRow(g, moveCell(move)) + 49;
+	z1 = moveNewVal(move) + 48;
+	z2 = moveOldVal(move) + 48;
+	if (z1 == '0') z1 = '_';
+	if (z2 == '0') z2 = '_';
+	printf("Undo %c,%c: from %c to %c\n", x, y, z1, z2);
+}
+
+/*
+ * printRedo:
+ * ----------
+ * arguments:
+ * g - the game.
+ * move - the move to be printed.
+ * description:
+ * prints a message to the user, following an redo command.
+ */
+void printRedo (Game *g, Move move) {
+	char x, y, z1, z2;
+	x = getCol(g, moveCell(move)) + 49;
+	y = getRow(g, moveCell(move)) + 49;
+	z1 = moveOldVal(move) + 48;
+	z2 = moveNewVal(move) + 48;
+	if (z1 == '0') z1 = '_';
+	if (z2 == '0') z2 = '_';
+	printf("Redo %c,%c: from %c to %c\n", x, y, z1, z2);
+}
+
+/*
+ * printCell:
+ * ----------
+ * arguments:
+ * g - the game.
+ * x - column of the cell
+ * y - row of the cell.
+ * description:
+ * prints the cell <x,y> in the requested format
+ */
+void printCell(Game *g, int x, int y) {
+	int f = 0;
+	int n = getN(g, x, y);
+	printf(" ");
+	if (getVal(g, n) == 0) printf("  ");
+	else printf("%2d", getVal(g, n));
+	if (isFixedCell(g, n)) {
+		printf(".");
+		f = 1;
+	}
+	else{
+		if ((g->mode ==  Edit) || g->markErrors == 1){
+			if (isErrorCell(g, n)) {
+				printf("*");
+				f = 1;
+			}
+		}
+	}
+	if (f==0) printf(" ");
+
+}
+
+/*
+ * printSeparatorRow:
+ * ------------------
+ * arguments:
+ * g - the game.
+ * description:
+ * prints a separator row in the requested format.
+ */
+void printSeparatorRow (Game *g) {
+	int i, n = g->blockH, m = g->blockW;
+	for (i=0; i<(4*n*m + n); i++)
+		printf("-");
+	printf("-\n");
+}
+
+/*
+ * printRow:
+ * ---------
+ * arguments:
+ * g - the game.
+ * r - number of the row.
+ * description:
+ * prints a row (filled with cells) in the requested format.
+ */
+void printRow(Game *g, int r) {
+	int j;
+	for (j=0; j<g->N; j++){
+		if ((j%g->blockW) == 0)
+			printf("|");
+		printCell(g, j,r);
+	}
+	printf("|\n");
+}
+
+/*
+ * printgb:
+ * ---------
+ * arguments:
+ * g - the game.
+ * description:
+ * prints the game board according to the requested print format.
+ */
+void printgb(Game *g) {
+	int i;
+	for (i=0; i<g->N; i++){
+		if ((i%g->blockH) == 0)
+			printSeparatorRow(g);
+		printRow(g, i);
+	}
+	printSeparatorRow(g);
+}
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                      3. MEMORY ALLOCATION                       *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * memoryError:
+ * ------------
+ * arguments:
+ * none.
+ * description:
+ * prints an error message and closes the program. to be called when
+ * the console, or the engine on its behalf, runs out of memory.
+ */
+void memoryError(void) {
+	printf("Fatal error: memory allocation failed\n");
+	exit(EXIT_FAILURE);
+}
+
+/*
+ * safealloc:
+ * ---------
+ * arguments:
+ * size - size of the memory to be allocated.
+ * description:
+ * attempts to allocate memory of the requested size.
+ * if allocation was successful, return a pointer to the memory address.
+ * if allocation fails, tries again. if failed twice,
+ * closes the program (see memoryError). no game is
+ * freed, since the allocation may not belong to one.
+ */
+void * safealloc(int size) {
+	void *p = malloc(size);
+	if (p == NULL) {
+		p = malloc(size);
+		if (p==NULL) {
+			memoryError();
+		}
+	}
+	return p;
+}
@@ -0,0 +1,26 @@
+/*
+ * Console.h
+ *
+ * this file allows the console's modules to use the functions
+ * from Console.c.
+ *
+ */
+
+#ifndef CONSOLE_H_
+#define CONSOLE_H_
+
+#include "DataStructures.h"
+
+int isNum(char *st);
+int hasNewLine(char input[]);
+int parseMarkErrorInput(char * token);
+void printUndo(Game *g, Move move);
+void printRedo(Game *g, Move move);
+void printCell(Game *g, int x, int y);
+void printSeparatorRow(Game *g);
+void printRow(Game *g, int r);
+void printgb(Game *g);
+void memoryError(void);
+void * safealloc(int size);
+
+#endif /* CONSOLE_H_ */
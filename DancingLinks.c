@@ -0,0 +1,313 @@
+/*
+ * DancingLinks.c
+ *
+ * this file implements a sudoku solver based on Knuth's Algorithm X,
+ * using the dancing-links technique.
+ * the board is represented as an exact-cover problem: every matrix row is
+ * a (cell, value) option, and it covers 4 columns - the cell itself, and the
+ * value in the cell's row, column and block. all matrix nodes are taken from
+ * a single node-pool (DLXArena) that is allocated once per solve.
+ * contents:
+ * 1. node-pool functions. (private)
+ * 2. algorithm X functions. (private)
+ * 3. solve function - DLXsolve. (public)
+ *
+ */
+
+#include <stdlib.h>
+#include "DataStructures.h"
+#include "AuxMethods.h"
+#include "Solver.h"
+#include "DancingLinks.h"
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                         1. NODE-POOL                            *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * createArena:
+ * ------------
+ * arguments:
+ * a - the arena to initialize.
+ * numCols - number of columns in the matrix.
+ * maxNodes - maximal number of nodes (root and column headers included).
+ * maxDepth - maximal number of rows in a solution.
+ * description:
+ * allocates the node-pool in a single block, and links the root
+ * and the (empty) column headers.
+ * returns 1 on success, and 0 if there is not enough memory.
+ */
+int createArena(DLXArena *a, int numCols, int maxNodes, int maxDepth) {
+	int i;
+	a->pool = malloc((7*maxNodes + maxDepth)*sizeof(int));
+	if (a->pool == NULL) {
+		return 0;
+	}
+	a->left = a->pool;
+	a->right = a->left + maxNodes;
+	a->up = a->right + maxNodes;
+	a->down = a->up + maxNodes;
+	a->col = a->down + maxNodes;
+	a->rowId = a->col + maxNodes;
+	a->size = a->rowId + maxNodes;
+	a->solution = a->size + maxNodes;
+	a->numCols = numCols;
+	a->numNodes = numCols + 1;
+
+	/*node 0 is the root, nodes 1..numCols are the column headers*/
+	for (i = 0; i <= numCols; i++) {
+		a->left[i] = (i == 0) ? numCols : i - 1;
+		a->right[i] = (i == numCols) ? 0 : i + 1;
+		a->up[i] = i;
+		a->down[i] = i;
+		a->col[i] = i;
+		a->size[i] = 0;
+	}
+	return 1;
+}
+
+/*
+ * freeArena:
+ * ----------
+ * arguments:
+ * a - the arena to free.
+ * description:
+ * frees the node-pool of 'a'.
+ */
+void freeArena(DLXArena *a) {
+	free(a->pool);
+	a->pool = NULL;
+}
+
+/*
+ * appendNode:
+ * -----------
+ * arguments:
+ * a - the arena.
+ * c - the column header the new node belongs to.
+ * rowId - the id of the matrix row the new node belongs to.
+ * description:
+ * takes a new node from the pool, and links it to the bottom of column c.
+ * returns the index of the new node.
+ */
+int appendNode(DLXArena *a, int c, int rowId) {
+	int x = a->numNodes++;
+	a->col[x] = c;
+	a->rowId[x] = rowId;
+	a->up[x] = a->up[c];
+	a->down[x] = c;
+	a->down[a->up[c]] = x;
+	a->up[c] = x;
+	a->size[c]++;
+	return x;
+}
+
+/*
+ * addOption:
+ * ----------
+ * arguments:
+ * a - the arena.
+ * s - the state of the board being solved.
+ * n - the number of the cell (counting left to right, then top to bottom).
+ * v - the value (0 to N-1) to be placed in the cell.
+ * description:
+ * adds the matrix row representing "cell n holds value v+1", which covers
+ * the cell column and the value's row, column and block columns.
+ */
+void addOption(DLXArena *a, SolverState *s, int n, int v) {
+	int N = s->N, NN = N*N, i, nodes[4];
+	int col = s->cellCol[n], row = s->cellRow[n], block = s->cellBlock[n];
+
+	nodes[0] = appendNode(a, 1 + n, n*N + v);
+	nodes[1] = appendNode(a, 1 + NN + row*N + v, n*N + v);
+	nodes[2] = appendNode(a, 1 + 2*NN + col*N + v, n*N + v);
+	nodes[3] = appendNode(a, 1 + 3*NN + block*N + v, n*N + v);
+
+	/*link the 4 nodes into a circular list*/
+	for (i = 0; i < 4; i++) {
+		a->right[nodes[i]] = nodes[(i + 1)%4];
+		a->left[nodes[i]] = nodes[(i + 3)%4];
+	}
+}
+
+/*
+ * buildMatrix:
+ * ------------
+ * arguments:
+ * a - an initialized arena.
+ * s - the state of the board being solved.
+ * description:
+ * adds the options of the board in 's' to the matrix. a filled cell
+ * only gets the option of its current value, an empty cell gets
+ * one option for each of its remaining candidates.
+ */
+void buildMatrix(DLXArena *a, SolverState *s) {
+	int n, v, N = s->N;
+	unsigned int cands;
+	for (n = 0; n < N*N; n++) {
+		if (s->vals[n]) {
+			addOption(a, s, n, s->vals[n] - 1);
+			continue;
+		}
+		cands = candidatesOf(s, n);
+		for (v = 0; v < N; v++) {
+			if (cands & (1u << v)) {
+				addOption(a, s, n, v);
+			}
+		}
+	}
+}
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                        2. ALGORITHM X                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * coverColumn:
+ * ------------
+ * arguments:
+ * a - the arena.
+ * c - the column header to cover.
+ * description:
+ * removes column c from the header list, and removes every row
+ * intersecting c from the other columns.
+ */
+void coverColumn(DLXArena *a, int c) {
+	int i, j;
+	a->right[a->left[c]] = a->right[c];
+	a->left[a->right[c]] = a->left[c];
+	for (i = a->down[c]; i != c; i = a->down[i]) {
+		for (j = a->right[i]; j != i; j = a->right[j]) {
+			a->down[a->up[j]] = a->down[j];
+			a->up[a->down[j]] = a->up[j];
+			a->size[a->col[j]]--;
+		}
+	}
+}
+
+/*
+ * uncoverColumn:
+ * --------------
+ * arguments:
+ * a - the arena.
+ * c - the column header to uncover.
+ * description:
+ * exactly reverts coverColumn(a, c).
+ */
+void uncoverColumn(DLXArena *a, int c) {
+	int i, j;
+	for (i = a->up[c]; i != c; i = a->up[i]) {
+		for (j = a->left[i]; j != i; j = a->left[j]) {
+			a->size[a->col[j]]++;
+			a->down[a->up[j]] = j;
+			a->up[a->down[j]] = j;
+		}
+	}
+	a->right[a->left[c]] = c;
+	a->left[a->right[c]] = c;
+}
+
+/*
+ * chooseColumn:
+ * -------------
+ * arguments:
+ * a - the arena.
+ * description:
+ * returns the uncovered column with the fewest nodes.
+ * assumes at least one column is uncovered.
+ */
+int chooseColumn(DLXArena *a) {
+	int c, best = a->right[0];
+	for (c = a->right[best]; c != 0; c = a->right[c]) {
+		if (a->size[best] <= 1) {
+			break;
+		}
+		if (a->size[c] < a->size[best]) {
+			best = c;
+		}
+	}
+	return best;
+}
+
+/*
+ * searchCover:
+ * ------------
+ * arguments:
+ * a - the arena.
+ * depth - number of rows chosen so far.
+ * description:
+ * looks for an exact cover of the remaining columns, recording the chosen
+ * rows in a->solution.
+ * returns the total number of rows in the cover if one was found, or
+ * -1 otherwise. once a cover is found the matrix is left covered.
+ */
+int searchCover(DLXArena *a, int depth) {
+	int c, r, j, result;
+
+	if (a->right[0] == 0) { /*all columns are covered*/
+		return depth;
+	}
+	c = chooseColumn(a);
+	if (a->size[c] == 0) {
+		return -1;
+	}
+
+	coverColumn(a, c);
+	for (r = a->down[c]; r != c; r = a->down[r]) {
+		a->solution[depth] = r;
+		for (j = a->right[r]; j != r; j = a->right[j]) {
+			coverColumn(a, a->col[j]);
+		}
+		result = searchCover(a, depth + 1);
+		if (result >= 0) {
+			return result;
+		}
+		for (j = a->left[r]; j != r; j = a->left[j]) {
+			uncoverColumn(a, a->col[j]);
+		}
+	}
+	uncoverColumn(a, c);
+	return -1;
+}
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                       3. SOLVE FUNCTION                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * DLXsolve:
+ * ---------
+ * arguments:
+ * g - the game.
+ * s - a state loaded with the game board (possibly propagated).
+ * description:
+ * solves the board in 's' as an exact-cover problem with dancing links.
+ * if a solution was found, stores it in the demiVal field of the cells of g.
+ * returns 1 if a solution was found, 0 if there is none, and -1 if there
+ * is not enough memory for the matrix.
+ */
+int DLXsolve(Game *g, SolverState *s) {
+	DLXArena a;
+	int i, id, depth, N = s->N;
+
+	if (!createArena(&a, 4*N*N, 1 + 4*N*N + 4*N*N*N, N*N)) {
+		return -1;
+	}
+	buildMatrix(&a, s);
+	depth = searchCover(&a, 0);
+
+	/*store the solution*/
+	for (i = 0; i < depth; i++) {
+		id = a.rowId[a.solution[i]];
+		setDemiVal(g, id/N, id%N + 1);
+	}
+
+	freeArena(&a);
+	return depth >= 0;
+}
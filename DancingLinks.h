@@ -0,0 +1,14 @@
+/*
+ * DancingLinks.h
+ *
+ * this file allows other modules to use the dancing-links solver.
+ */
+
+#ifndef DANCINGLINKS_H_
+#define DANCINGLINKS_H_
+
+#include "DataStructures.h"
+
+int DLXsolve(Game *g, SolverState *s);
+
+#endif /* DANCINGLINKS_H_ */
@@ -2,13 +2,12 @@
  * DataStructures.c
  *
  * this file is where we declare the global variable 'myGame',
- * that will be used throughout the code to store the board
- * information.
+ * the game played on the console. the rest of the code gets
+ * the game it works on as an argument.
  *
  */
 
 #include "DataStructures.h"
 
-Game myGame; /* myGame is the Game-type-variable that will be
-              * be referred to throughout the code.*/
+Game myGame; /* myGame is the console's game (see gameLoop).*/
 
@@ -11,38 +11,42 @@
 
 
 /*
- * Cell:
+ * Move:
  * -----
- * implementation of a board cell.
+ * a record of the moves-log, packed into 32 bits. a move (see packMove)
+ * holds the number of the cell in bits 0-9, its old value in bits 10-14,
+ * and its new value in bits 15-19. a group header has bit 20 set, and
+ * holds the number of moves in the group in bits 0-19.
  */
-struct Cell
-{
-	int
-		isFixed,
-		isError,
-		val,
-		demiVal; /*this field will be used when we want to store a value without changing the original*/
-} ;
-typedef struct Cell Cell;
+typedef unsigned int Move;
 
 /*
- * MovesList:
- * ----------
- * implementation of a move in the moves-list.
+ * MovesLog:
+ * ---------
+ * implementation of the moves-list: all the moves of the game, in order,
+ * in one growable array. the moves before the cursor are done, and the
+ * ones from the cursor on can be redone. moves that are undone and redone
+ * together (as in generate and autofill) are stored as a group: a header,
+ * the moves, and a copy of the header. a move or a group is a step.
+ * every few steps, the values of the board are kept as a checkpoint.
  */
-struct MovesList
+typedef struct
 {
 	int
-		row,
-		col,
-		oldVal,
-		newVal,
-		user; /*this field indicates whether the was user made or automatic (as in generate and autofill).*/
-	struct MovesList
-		*next,
-		*prev;
-} ;
-typedef struct MovesList MovesList;
+		numMoves, /*number of records in the log*/
+		curr, /*the cursor: the number of records done*/
+		capacity, /*number of records the array can hold*/
+		groupStart, /*the index of the header of the open group of moves, or -1*/
+		step, /*the number of steps (moves or groups of moves) done*/
+		numSteps, /*number of steps in the log*/
+		numCheckpoints,
+		checkpointCapacity,
+		*checkpoints; /*checkpoint i is taken after step (i+1)*CHECKPOINT_STEPS: the cursor at that step*/
+	unsigned char
+		*checkpointVals; /*the values of the board at checkpoint i are at checkpointVals + i*N*N*/
+	Move
+		*moves;
+} MovesLog;
 
 /*
  * Mode:
@@ -55,10 +59,45 @@ enum Mode{
 	Edit
 };
 
+/*
+ * SolutionCache:
+ * --------------
+ * the last few solutions found for the game board,
+ * used by hint and validate instead of solving again.
+ */
+typedef struct
+{
+	int
+		size, /*cells in a solution (N*N), 0 before the first solution is cached*/
+		numSolutions,
+		clock, /*counts the uses of the cache, to find the least recently used solution*/
+		*solutions, /*solution i is at solutions + i*size*/
+		*conflicts, /*for every solution: the number of filled cells of the board that contradict it*/
+		*lastUsed; /*for every solution: the clock when it was last stored or used*/
+} SolutionCache;
+
+/*
+ * BoardHash:
+ * ----------
+ * a 64-bit Zobrist hash, kept as two 32-bit halves, as C89 has no 64-bit
+ * type (unsigned long may be only 32 bits wide).
+ */
+typedef struct
+{
+	unsigned long
+		hi, /*the high 32 bits*/
+		lo; /*the low 32 bits*/
+} BoardHash;
+
 /*
  * Game:
  * -----
  * a struct that stores all game parameters and relevant pointers.
+ * the board is stored as one array per field of a cell, indexed by the
+ * cell's number (left to right, then top to bottom), and is accessed
+ * through getVal, getDemiVal, isFixedCell and isErrorCell (see AuxMethods.c).
+ * every function working on a game gets it as its first argument, so
+ * several games can be used at once (see initGame).
  */
 typedef struct
 {
@@ -68,44 +107,108 @@ typedef struct
 		N, /*size of a row/column*/
 		markErrors,
 		numFilled,
-		notNew; /*indicates whether memory was allocated to board, sentinel and currMoves*/
+		errorCount, /*number of cells marked as erroneous*/
+		notNew; /*indicates whether memory was allocated to board and moves-log*/
+	BoardHash
+		hash; /*Zobrist hash of the board's values (see boardHash)*/
+	unsigned long
+		rng; /*the state of the game's random numbers (see seedGame and nextRandom)*/
 	enum Mode
 		mode;
-	MovesList
-		*sentinel, /*a MovesList variable indicating the beggining of the moves-list*/
-		*currMove; /* a pointer to the current move. */
-	Cell
-		*board;
+	MovesLog
+		log; /*the moves-list*/
+	unsigned char
+		*vals, /*the value of every cell, 0 if empty*/
+		*demiVals, /*a value per cell, used when we want to store a value without changing the original*/
+		*initVals; /*a copy of vals as it was created or loaded, restored by reset*/
+	unsigned int /*bitsets: bit n%32 of word n/32 is set iff the n'th cell has the flag*/
+		*fixedBits,
+		*errorBits;
+	unsigned int /*bit v-1 is set iff value v is used in the unit*/
+		*rowMask,
+		*colMask,
+		*blockMask;
+	int
+		*unitCount, /*unitCount[unit*N + v-1] is the number of cells of the unit (see Kernels.c) holding value v*/
+		*unitCells, /*unitCells[unit*UNIT_PAD + i] is the i'th cell of the unit, computed once by createUnitLayouts*/
+		*unitRows, /*the row, column and block of every cell in unitCells (all four point into one allocation)*/
+		*unitCols,
+		*unitBlocks;
+	SolutionCache
+		cache; /*the last solutions found for the board (see SolutionCache.c)*/
 } Game;
-extern Game myGame; /* myGame is the Game-type-variable that will be
-                     * be referred to throughout the code.*/
+extern Game myGame; /* myGame is the console's game (see gameLoop).*/
 
 /*
- * Elem:
- * -----
- * an implementation of a stack element.
+ * DLXArena:
+ * ---------
+ * a node-pool holding the exact-cover matrix of the dancing-links solver.
+ * node 0 is the root, nodes 1 to numCols are the column headers, and the rest
+ * are matrix nodes. all the arrays point into a single allocation (pool).
  */
-struct Elem
+typedef struct
 {
-	int	cellIndex;
-	MovesList *move; /* to be used in the prints accompanying undo and redo.*/
-	struct Elem *next;
-} ;
-typedef struct Elem Elem;
+	int
+		numCols,
+		numNodes, /*number of nodes currently in use*/
+		*left,
+		*right,
+		*up,
+		*down,
+		*col, /*the column header of each node*/
+		*rowId, /*for matrix nodes: (cell number)*N + (value - 1)*/
+		*size, /*for column headers: the number of nodes in the column*/
+		*solution, /*the matrix rows chosen so far, by search depth*/
+		*pool;
+} DLXArena;
 
 /*
- * Stack:
- * ------
- * an implementation of a stack.
- * to be used in: num_solutions,
- * undo and redo.
+ * SolverState:
+ * ------------
+ * a self-contained copy of a board, used by the bitmask search engine.
+ * it doesn't refer to myGame, so several can be used at once.
+ * all arrays are allocated once, when the state is created.
  */
-struct Stack
+typedef struct
 {
-	int numOfElements;
-	struct Elem *top;
-};
-typedef struct Stack Stack;
+	int
+		blockH,
+		blockW,
+		N,
+		numEmpty, /*number of cells in 'empty'*/
+		*vals, /*the value of every cell (0 for empty)*/
+		*cellRow, /*the row of every cell*/
+		*cellCol, /*the column of every cell*/
+		*cellBlock, /*the block of every cell*/
+		*empty, /*the empty cells. during a search, the cells from the current depth on are unfilled*/
+		*units, /*the N cells of every unit: rows are units 0 to N-1, columns N to 2N-1, blocks 2N to 3N-1*/
+		*unitQueue, /*the propagation worklist of units*/
+		*queued; /*for every unit: whether it is in the worklist*/
+	unsigned int /*bit v-1 is set iff value v is used in the unit*/
+		*rowMask,
+		*colMask,
+		*blockMask,
+		*allowed, /*for every cell: the values not eliminated by propagation*/
+		*untried, /*for every search depth: the candidates not tried yet*/
+		*placed; /*for every search depth: the bit of the value currently placed*/
+} SolverState;
+
+/*
+ * GridPool:
+ * ---------
+ * a list of solved grids of one block size, from which
+ * new grids are derived by symmetry transforms.
+ */
+typedef struct GridPool
+{
+	int
+		blockW,
+		blockH,
+		numGrids,
+		*grids; /*grid g is at grids + g*N*N, listed left to right, then top to bottom*/
+	struct GridPool
+		*next; /*the pool of the next block size*/
+} GridPool;
 
 
 #endif /* DATASTRUCTURES_H_ */
@@ -9,25 +9,105 @@
  * manages the game flow - recieveing input from the user and
  * passing it to the parser.
  *
+ * the commands work through the engine (see Sudoku.c), and report its
+ * results to the user.
+ *
  * contents:
- * 1. command-handling functions. (public)
- * 2. game-flow function - gameLoop. (public)
+ * 1. auxiliary functions - reportCompletion, reportFilled, checkMemory. (private)
+ * 2. command-handling functions. (public)
+ * 3. game-flow function - gameLoop. (public)
  *
  */
 
 #include "DataStructures.h"
 #include "AuxMethods.h"
+#include "Console.h"
 #include "Validate.h"
 #include "Parser.h"
 #include "Game.h"
+#include "GridPool.h"
+#include "ParallelCount.h"
+#include "Sudoku.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <errno.h>
+#include <time.h>
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                    1. AUXILIARY FUNCTIONS                       *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * reportCompletion:
+ * -----------------
+ * arguments:
+ * g - the game.
+ * description:
+ * to be called after cells were changed. if the board was filled in
+ * SOLVE mode, tells the user whether it is solved, and a solved puzzle
+ * returns the game to INIT mode.
+ */
+void reportCompletion(Game *g) {
+	if ((g->mode == Solve) && (g->numFilled == g->N*g->N)) {
+		if (g->errorCount) /*a full board without erroneous cells is solved*/
+			printf("Puzzle solution erroneous\n");
+		else{
+			printf("Puzzle solved successfully\n");
+			g->mode = Init;
+		}
+	}
+}
+
+/*
+ * reportFilled:
+ * -------------
+ * arguments:
+ * g - the game.
+ * cells - the cells set by autofill, in the order they were set.
+ * numCells - the number of these cells.
+ * description:
+ * tells the user which cells were set, and prints the board. if the last
+ * cell filled the board in SOLVE mode, the board is printed and the result
+ * reported before that cell (see reportCompletion); a solved puzzle ends
+ * the report there.
+ */
+void reportFilled(Game *g, int *cells, int numCells) {
+	int i, n;
+	for (i = 0; i < numCells; i++) {
+		n = cells[i];
+		if (i == numCells - 1 && g->mode == Solve && g->numFilled == g->N*g->N) {
+			printgb(g);
+			reportCompletion(g);
+			if (g->mode == Init) {
+				return;
+			}
+		}
+		printf("Cell <%d,%d> set to %d\n", getCol(g, n) + 1, getRow(g, n) + 1, getVal(g, n));
+	}
+	printgb(g);
+}
+
+/*
+ * checkMemory:
+ * ------------
+ * arguments:
+ * result - a result code returned by the engine (see Sudoku.h).
+ * description:
+ * returns 'result', unless the engine ran out of memory: then the program
+ * is closed, as when the console itself runs out of memory (see memoryError).
+ */
+int checkMemory(int result) {
+	if (result == SudokuOutOfMemory) {
+		memoryError();
+	}
+	return result;
+}
 
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- *                 1. COMMAND HANDLING FUNCTIONS                   *
+ *                 2. COMMAND HANDLING FUNCTIONS                   *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 
@@ -35,63 +115,41 @@
  * solve:
  * ------
  * arguments:
+ * g - the game.
  * file_name - a string containing the address of the file to load from.
  * description:
  * a method handling the user-command 'solve'.
  * loads a board in solve mode from the file "file_name".
  * reports error to the user if the loading process fails.
  */
-void solve(char *file_name){
-	FILE *ifp = NULL;
-	int m,n,i,j;
-	Cell *cell;
-	errno = 0;
-	ifp = fopen(file_name, "r");
-	if (errno) {
-		printf("Error: File doesn't exist or cannot be opened\n");
-		return;
-	}
-	if (ifp == NULL) {
+void solve(Game *g, char *file_name){
+	if (checkMemory(sudokuLoad(g, file_name, Solve)) != SudokuOk) {
 		printf("Error: File doesn't exist or cannot be opened\n");
-		fclose(ifp);
 		return;
-	} else {
-		/*get board dimensions and create board*/
-		m = readSize(ifp);
-		n = readSize(ifp);
-		createGame(n, m, Solve);
-		/*read and fill cells*/
-		for (i=0; i<myGame.N; i++){ /* row i*/
-			for (j=0; j<myGame.N; j++){ /*column j*/
-				cell = getCell(j,i);
-				readNextCell(ifp,cell);
-				checkIfError(j, i, cell->val, 0);
-			}
-		}
 	}
-	fclose(ifp);
-	printgb();
+	printgb(g);
 }
 
 /*
  * edit:
  * -----
  * arguments:
- * none.
+ * g - the game.
  * description:
  * a method handling the user-command 'edit', when it doesnt
  * have an additional file address argument.
  * creates a 3x3 board in edit mode and prints the board.
  */
-void edit(){
-	createGame(3,3,Edit);
-	printgb();
+void edit(Game *g){
+	checkMemory(sudokuNew(g, 3, 3, Edit));
+	printgb(g);
 }
 
 /*
  * edit1:
  * ------
  * arguments:
+ * g - the game.
  * file_name - a string containing the address of the file to load from.
  * description:
  * a method handling the user-command 'edit', when a file address
@@ -99,46 +157,19 @@ void edit(){
  * loads a board in edit mode from the file "file_name".
  * reports error to the user if the loading process fails.
  */
-void edit1(char *file_name){
-	FILE *ifp = NULL;
-	int m,n,i,j;
-	Cell *cell;
-
-	errno = 0;
-	ifp = fopen(file_name, "r");
-	if (errno) {
-		printf("Error: File cannot be opened\n");
-		return;
-	}
-	if (ifp == NULL) {
+void edit1(Game *g, char *file_name){
+	if (checkMemory(sudokuLoad(g, file_name, Edit)) != SudokuOk) {
 		printf("Error: File cannot be opened\n");
-		fclose(ifp);
 		return;
 	}
-
-	else{
-		/*get board dimensions and create board*/
-		m = readSize(ifp);
-		n = readSize(ifp);
-		createGame(n, m, Edit);
-		/*read and fill cells*/
-		for (i=0; i<myGame.N; i++){
-			for (j=0; j<myGame.N;j++){
-				cell = getCell(j,i);
-				readNextCell(ifp,cell);
-				cell->isFixed = 0;
-				checkIfError(j, i, cell->val, 0);
-			}
-		}
-	}
-	fclose(ifp);
-	printgb();
+	printgb(g);
 }
 
 /*
  * set:
  * ----
  * arguments:
+ * g - the game.
  * n1 - cell's column.
  * n2 - cell's row.
  * n3 - cell's new value.
@@ -148,48 +179,50 @@ void edit1(char *file_name){
  * prints the relevant error messages if necessary.
  * updates the relevant data structures.
  */
-void set(int n1,int n2,int n3){
-	if (((n1<1) || (n1>myGame.N)) || ((n2<1) || (n2>myGame.N)) || ((n3<0) || (n3>myGame.N)))
-		printf("Error: value not in range 0-%d\n",myGame.N);
-	else{
-		--n2;
-		--n1;
-		if ((getCell(n1,n2)->isFixed))
-			printf("Error: cell is fixed\n");
-		else{
-			setCell(n1,n2,n3,1);
-			if (myGame.mode == Init || myGame.numFilled == myGame.N*myGame.N) {
-				return;
-			}
-			printgb();
-		}
+void set(Game *g, int n1,int n2,int n3){
+	switch (checkMemory(sudokuSet(g, n1 - 1, n2 - 1, n3))) {
+	case SudokuOutOfRange:
+		printf("Error: value not in range 0-%d\n",g->N);
+		return;
+	case SudokuFixedCell:
+		printf("Error: cell is fixed\n");
+		return;
+	default:
+		break;
+	}
+	if (g->mode == Solve && g->numFilled == g->N*g->N) { /*if this is the last cell to be filled*/
+		printgb(g);
+		reportCompletion(g);
+	}
+	if (g->mode == Init || g->numFilled == g->N*g->N) {
+		return;
 	}
+	printgb(g);
 }
 
 /*
  * validate:
  * ---------
  * arguments:
- * none.
+ * g - the game.
  * description:
  * a method handling the user-command 'validate'.
  * if board is erroneus, prints error message and returns.
- * solves the board using ILP (by calling ILPvalidate).
+ * if a cached solution still agrees with the board, the board is solvable.
+ * otherwise, solves the board using ILP (see sudokuSolve).
  * reports result to the user.
  */
-void validate() {
-
-	/*check whether board is erroneous*/
-	if (isErroneous()) {
+void validate(Game *g) {
+	/*a cached solution that agrees with the board proves it solvable.
+	  otherwise, use ILP to solve the board, and report result to the user*/
+	switch (checkMemory(sudokuSolve(g, NULL))) {
+	case SudokuErroneous:
 		printf("Error: board contains erroneous values\n");
-		return;
-	}
-
-	/*use ILP to solve the board, and report result to the user*/
-	clearDemiVals(0);
-	if (ILPvalidate()) {
+		break;
+	case SudokuOk:
 		printf("Validation passed: board is solvable\n");
-	} else {
+		break;
+	default:
 		printf("Validation failed: board is unsolvable\n");
 	}
 
@@ -199,451 +232,400 @@ void validate() {
  * generate:
  * ---------
  * arguments:
+ * g - the game.
  * x - number of cells to be randomly filled.
  * y - number of cells not to erase.
  * description:
  * a method handling the user-command 'generate'.
  * if arguments are not valid, or board is not empty, prints error message and returns.
- * tries to fill the board by calling tryGenerate(x,y). if generation fails,
- * it tries again. if 1000 attempts fail, prints a failure message and returns.
+ * fills the board by calling tryGenerate(y), which takes a random full grid
+ * from the grid pool and keeps Y of its cells. any X cells of the grid are X
+ * random cells filled with random legal values, so no attempt has to be retried.
  */
-void generate(int x,int y) {
-	int counter = 0, success = 0, numEmptyCells;
-
-	/*check the prerequisites*/
-	numEmptyCells = myGame.N*myGame.N - myGame.numFilled;
-	if (x > numEmptyCells || x < 0 || y < 0 || y > numEmptyCells) {
-		printf("Error: value not in range 0-%d\n", numEmptyCells);
-		return;
-	}
-	if (myGame.numFilled != 0) {
+void generate(Game *g, int x,int y) {
+	switch (checkMemory(sudokuGenerate(g, x, y))) {
+	case SudokuOk:
+		printgb(g);
+		break;
+	case SudokuOutOfRange:
+		printf("Error: value not in range 0-%d\n", g->N*g->N - g->numFilled);
+		break;
+	case SudokuNotEmpty:
 		printf("Error: board is not empty\n");
-		return;
+		break;
+	default:
+		printf("Error: puzzle generator failed\n");
 	}
-	/*try to generate:*/
-	while (counter < 1000) {
-		success = tryGenerate(x,y);
-		if (success) {
-			printgb();
-			return;
-		}
-		counter++;
+}
+
+/*
+ * generateUnique:
+ * ---------------
+ * arguments:
+ * g - the game.
+ * target - the number of clues to stop at (0 for a minimal puzzle).
+ * description:
+ * a method handling the user-command 'generate_unique'.
+ * if the argument is not valid, or board is not empty, prints error message and returns.
+ * fills the board with a puzzle that has a unique solution, by calling
+ * tryGenerateUnique(target). clues are removed from a random full grid until
+ * the puzzle is minimal (no clue can be removed without losing uniqueness),
+ * or until only 'target' clues are left. on large boards, the puzzle may not
+ * be minimal, and then the user is told so.
+ */
+void generateUnique(Game *g, int target) {
+	int clues;
+
+	switch (checkMemory(sudokuGenerateUnique(g, target, &clues))) {
+	case SudokuOk:
+		printgb(g);
+		printf("Generated a unique puzzle with %d clues\n", clues);
+		break;
+	case SudokuNotMinimal:
+		printgb(g);
+		printf("Generated a unique puzzle with %d clues (it may not be minimal)\n", clues);
+		break;
+	case SudokuOutOfRange:
+		printf("Error: value not in range 0-%d\n", g->N*g->N);
+		break;
+	case SudokuNotEmpty:
+		printf("Error: board is not empty\n");
+		break;
+	default:
+		printf("Error: puzzle generator failed\n");
 	}
-	printf("Error: puzzle generator failed\n");
 }
 
 /*
  * undo:
  * -----
  * arguments:
- * none.
+ * g - the game.
  * description:
  * a method handling the user-command 'undo'.
  * if there are no moves to undo. prints an error message and returns.
  * undoes the last move, and reports the changes to the user.
  */
-void undo(void) {
+void undo(Game *g) {
 
-	Stack *stack = safealloc(sizeof(Stack));
-	Elem *e = NULL;
-	stack->numOfElements = 0;
+	const Move *moves;
+	int i, numMoves;
 
-	/*check preconditions*/
-	if (myGame.currMove == myGame.sentinel) {
+	/*undo the last step, a move or a group of moves*/
+	if (sudokuUndo(g, &moves, &numMoves) == SudokuNoMoves) {
 		printf("Error: no moves to undo\n");
 		return;
 	}
 
-	/*undo moves (and record the undone moves in stack)*/
-	do {
-		push(stack, 0);
-		e = stack->top;
-		e->move = myGame.currMove;
-		undoAny();
-	} while (myGame.currMove->user == 0 && myGame.currMove != myGame.sentinel);
-
 	/*print the undone moves*/
-	printgb();
-	do {
-		e = stack->top;
-		printUndo(e->move);
-		e = pop(stack);
-		free(e);
-	} while (stack->numOfElements > 0);
-
-	free(stack);
+	printgb(g);
+	for (i = 0; i < numMoves; i++) {
+		printUndo(g, moves[i]);
+	}
 
 	/*if this is the last cell to be filled*/
-	if ((myGame.mode == Solve) && (myGame.numFilled == myGame.N*myGame.N)) {
-		if (!ILPvalidate()) /*validation failed*/
-			printf("Puzzle solution erroneous\n");
-		else{
-			printf("Puzzle solved successfully\n");
-			myGame.mode = Init;
-		}
-	}
+	reportCompletion(g);
 }
 
 /*
  * redo:
  * -----
  * arguments:
- * none.
+ * g - the game.
  * description:
  * a method handling the user-command 'redo'.
  * if there are no moves to redo. prints an error message and returns.
  * redoes the last move, and reports the changes to the user.
  */
-void redo(void) {
-	Stack *stack1 = malloc(sizeof(Stack));
-	Stack *stack2 = malloc(sizeof(Stack));
-	Elem *e = NULL;
-	stack1->numOfElements = 0;
-	stack2->numOfElements = 0;
-
-	/*check preconditions*/
-	if (myGame.currMove->next == NULL) {
+void redo(Game *g) {
+
+	const Move *moves;
+	int i, numMoves;
+
+	/*redo the next step, a move or a group of moves, and print its moves*/
+	if (sudokuRedo(g, &moves, &numMoves) == SudokuNoMoves) {
 		printf("Error: no moves to redo\n");
-		goto END;
 	}
-
-	/*redo a move*/
-	do {
-		redoAny();
-		push(stack1, 0);
-		stack1->top->move = myGame.currMove;
-	} while (myGame.currMove->user == 0);
-
-	/*create a second stack, which is the reverse of the first*/
-	do {
-		push(stack2, 0);
-		stack2->top->move = stack1->top->move;
-		e = pop(stack1);
-		free(e);
-	} while (stack1->numOfElements > 0);
-
-	/*print to the user*/
-	printgb();
-	do {
-		printRedo(stack2->top->move);
-		e = pop(stack2);
-		free(e);
-	} while (stack2->numOfElements > 0);
-
-	END:
-
-	free(stack1);
-	free(stack2);
+	else {
+		printgb(g);
+		for (i = 0; i < numMoves; i++) {
+			printRedo(g, moves[i]);
+		}
+	}
 
 	/*if this is the last cell to be filled*/
-	if ((myGame.mode == Solve) && (myGame.numFilled == myGame.N*myGame.N)) {
-		if (!ILPvalidate()) /*validation failed*/
-			printf("Puzzle solution erroneous\n");
-		else{
-			printf("Puzzle solved successfully\n");
-			myGame.mode = Init;
-		}
+	reportCompletion(g);
+}
+
+/*
+ * jump:
+ * -----
+ * arguments:
+ * g - the game.
+ * k - the number of steps to be done.
+ * description:
+ * a method handling the user-command 'jump'.
+ * if k is not between 0 and the number of steps in the moves-list, prints an
+ * error message and returns.
+ * undoes or redoes steps (moves, or groups of moves), until exactly 'k' of
+ * them are done (see sudokuJump).
+ */
+void jump(Game *g, int k) {
+
+	int numSteps;
+
+	if (sudokuJump(g, k, &numSteps) == SudokuOutOfRange) {
+		printf("Error: value not in range 0-%d\n", numSteps);
+		return;
 	}
+
+	printgb(g);
+	printf("Jumped to move %d of %d\n", k, numSteps);
+
+	/*if this is the last cell to be filled*/
+	reportCompletion(g);
 }
 
 /*
  * save:
  * -----
+ * g - the game.
  * address - a string containing file-address to save into.
  * a method handling the user-command 'save'.
  * saves the board into the file specified by 'address'.
+ * in EDIT mode, the board must be solvable, and the user is told
+ * if its solution isn't unique.
  * if an error occurs, reports it the user and returns.
  */
-void save(char* address) {
-
-	FILE *ifp = NULL;
-	Cell *cell;
-	int f,i,j,val;
-
-	/*check preconditions for EDIT mode*/
-	if (myGame.mode == Edit){
-		if (isErroneous()){
-			printf("Error: board contains erroneous values\n");
-			return;}
-		if (!(ILPvalidate())){
-			printf("Error: board validation failed\n");
-			return;}
-	}
-
-	/*attempt to open file*/
-	ifp = fopen(address, "w");
-	if (!ifp){
-		printf("Error: File cannot be created or modified\n");
-		return;}
-	if (!(writeSize(ifp, myGame.blockH, myGame.blockW)))
-		return;
-
-	/*if in EDIT mode, all filled cells should be saved as fixed*/
-	if (myGame.mode == Edit) {
-		for (i = 0; i < myGame.N*myGame.N; i++) {
-			cell = getCellN(i);
-			if (cell->val) {
-				cell->isFixed = 1;
-			} else {
-				cell->isFixed = 0;
-			}
-		}
-	}
+void save(Game *g, char* address) {
 
-	/*save game*/
-	for (i=0; i<myGame.N;i++){ /*rows*/
-		for (j=0; j<myGame.N - 1;j++) { /*columns*/
-			cell = getCell(j,i);
-			val = cell->val;
-			if (!(writeCell(ifp,cell,val))) {
-				return;
-			}
-		}
-		/*save last cell in a line*/
-		cell = getCell(j,i);
-		val = cell->val;
-		if (!(writeCellEndOfLine(ifp,cell,val)))
-			return;
-		f = fputc('\n', ifp);
-		if (!f) {
-			return;
-		}
-	}
+	int uniqueness;
 
-	/*if in edit mode, revert all cells to being unfixed*/
-	if (myGame.mode == Edit) {
-		for (i = 0; i < myGame.N*myGame.N; i++) {
-			getCellN(i)->isFixed = 0;	}
+	switch (checkMemory(sudokuSave(g, address, &uniqueness))) {
+	case SudokuOk:
+		printf("Saved to: %s\n",address);
+		if (uniqueness > 1) {
+			printf("Note: the puzzle has more than 1 solution\n");}
+		break;
+	case SudokuErroneous:
+		printf("Error: board contains erroneous values\n");
+		break;
+	case SudokuUnsolvable:
+		printf("Error: board validation failed\n");
+		break;
+	default:
+		printf("Error: File cannot be created or modified\n");
 	}
-	fclose(ifp);
-	printf("Saved to: %s\n",address);
 }
 
 /*
  * hint:
  * -----
  * arguments:
+ * g - the game.
  * col - hinted cell's column.
  * row - hinted cell's row.
  * description:
  * a method handling the user-command 'hint'.
  * if the arguments are not valid, board is erroneus, cell is fixed
  * or already contains a value, prints error message and returns.
- * solves the board using ILP.
+ * if a cached solution still agrees with the board, hints from it.
+ * otherwise, if an empty cell has no legal value, reports the board as
+ * unsolvable, and if not, solves the board using ILP (see sudokuHint).
  * if board is solvable:
  *     hints the user for the value of cell <col,row>/
  * else:
  *     prints an error message.
  */
-void hint(int col, int row) {
-	int N = myGame.N;
-	int solvable;
-
-	/*check preconditions*/
-
-	if (col < 0 || col >= N || row < 0 || row >= N) {
-		printf("Error: value not in range 1-%d\n", N);
-		return;
-	}
-
-	if (isErroneous()) {
+void hint(Game *g, int col, int row) {
+	int val;
+
+	switch (checkMemory(sudokuHint(g, col, row, &val))) {
+	case SudokuOk:
+		printf("Hint: set cell to %d\n", val);
+		break;
+	case SudokuOutOfRange:
+		printf("Error: value not in range 1-%d\n", g->N);
+		break;
+	case SudokuErroneous:
 		printf("Error: board contains erroneous values\n");
-		return;
-	}
-
-	if (getCell(col,row)->isFixed) {
+		break;
+	case SudokuFixedCell:
 		printf("Error: cell is fixed\n");
-		return;
-	}
-
-	if (getCell(col,row)->val) {
+		break;
+	case SudokuFilledCell:
 		printf("Error: cell already contains a value\n");
-		return;
-	}
-
-	/*do ILP solve*/
-
-	clearDemiVals(0);
-	solvable = ILPvalidate();
-
-	if (!solvable) {
+		break;
+	default:
 		printf("Error: board is unsolvable\n");
-		return;
 	}
 
-	/*print result*/
-
-	printf("Hint: set cell to %d\n", getCell(col, row)->demiVal);
-
 }
 
 /*
  * numSolutions:
  * -------------
  * arguments:
- * none.
+ * g - the game.
+ * numThreads - the number of threads to count with (0 for all cores).
  * description:
  * a method handling the user-command 'num_solutions'.
  * if the board is erroneous, prints an error message and returns.
- * finds the number of solutions for the board, using a backtracking
- * algorithm with a stack.
- * reports the result the user.
+ * finds the number of solutions for the board, using constraint propagation
+ * followed by the bitmask search engine, split between 'numThreads' threads
+ * (see sudokuCount).
+ * reports the result the user, and tells if fewer threads were used.
  */
-void numSolutions(void) {
+void numSolutions(Game *g, int numThreads) {
 
-	int counter = 0, index = nextEmptyCell(0), N = myGame.N;
-	Stack *st = malloc(sizeof(Stack));
-	Elem *e = NULL;
+	long counter;
+	int threadsUsed;
 
-	/*check preconditions*/
-	if (isErroneous()) {
+	if (checkMemory(sudokuCount(g, numThreads, &counter, &threadsUsed)) != SudokuOk) {
 		printf("Error: board contains erroneous values\n");
 		return;
 	}
-
-	/*find no. of solutions*/
-	st->numOfElements = 0;
-	clearDemiVals(0);
-	push(st, index);
-	while (st->numOfElements > 0) {
-		e = st->top;
-		index = e->cellIndex;
-		if (index >= N*N) { /*board is filled with a valid solution*/
-			counter++;
-			e = pop(st);
-			free(e);
-			continue;
-		}
-		if (getCellN(index)->val) { /*if cell already contains a value, find the next empty cell*/
-			index = nextEmptyCell(index+1);
-			push(st, index);
-			continue;}
-		while (1) {
-			e = st->top;
-			index = e->cellIndex;
-			clearDemiVals(index + 1);
-			copyValsToDemivals();
-			getCellN(index)->demiVal++;
-			if (getCellN(index)->demiVal > N) { /*it means we have exhausted the options for this cell, and should backtrack*/
-				e = pop(st);
-				free(e);
-				break;}
-			if (isDemiValid(index)) { /*if demiVal is valid, we move to the next empty cell*/
-				index = nextEmptyCell(index+1);
-				push(st, index);
-				break;}
-		}
+	if (numThreads == 0) {
+		numThreads = getNumCores();
+	}
+	if (threadsUsed < numThreads) {
+		printf("Note: counted with %d of %d threads\n", threadsUsed, numThreads);
 	}
 
 	/*report result to the user*/
-	printf("Number of solutions: %d\n", counter);
+	printf("Number of solutions: %ld\n", counter);
 	if (counter == 1) {
 		printf("This is a good board!\n");}
 	if (counter > 1) {
 		printf("The puzzle has more than 1 solution, try to edit it further\n");}
-	free(st);
+}
+
+/*
+ * checkUnique:
+ * ------------
+ * arguments:
+ * g - the game.
+ * description:
+ * a method handling the user-command 'check_unique'.
+ * if the board is erroneous, prints an error message and returns.
+ * reports whether the board has no solution, a unique solution or more
+ * than one. unlike num_solutions, the search stops once a second
+ * solution is found.
+ */
+void checkUnique(Game *g) {
+
+	int uniqueness;
+
+	if (checkMemory(sudokuCheckUnique(g, &uniqueness)) != SudokuOk) {
+		printf("Error: board contains erroneous values\n");
+		return;
+	}
+
+	/*report result to the user*/
+	if (uniqueness == 0) {
+		printf("Validation failed: board is unsolvable\n");}
+	if (uniqueness == 1) {
+		printf("This is a good board!\n");}
+	if (uniqueness > 1) {
+		printf("The puzzle has more than 1 solution, try to edit it further\n");}
 }
 
 /*
  * autofill:
  * ---------
  * arguments:
- * none.
+ * g - the game.
  * description:
  * a method handling the user-command 'autofill'.
  * if the board is erroneous, prints an error message and returns.
- * fills all cells in the board that have only 1 valid option.
+ * fills all cells in the board that have only 1 valid option
+ * (a single pass; see autofillAll), and reports them (reportFilled).
  */
-void autofill(void) {
-
-	int last = -1;
-	int index = 0;
-	int N = myGame.N;
-	int v = 0;
-	int val = 0;
-	Cell *cell;
-	/*check preconditions*/
-	if (isErroneous()) {
+void autofill(Game *g) {
+
+	int cells[MAX_N*MAX_N];
+	int numCells;
+
+	if (checkMemory(sudokuAutofill(g, 0, cells, &numCells)) == SudokuErroneous) {
 		printf("Error: board contains erroneous values\n");
 		return;
 	}
-	/*if there is a single value for a cell, save it in cell->demiVal*/
-	clearDemiVals(0);
-	while (1) {
-		if (index >= N*N) {
-			break;}
-		cell = getCellN(index);
-		if (cell->val) {
-			index++;
-			continue;}
-		val = getCellSingleValue(index);
-		if (val == 0) {
-			index++;
-			continue;	}
-		cell->demiVal = val;
-		last = index;
-		index++;}
-	/*for every cell with a saved demiVals, set the cell to this value*/
-	if (last < 0) {
-		printgb();
-		return;
-	}
-	for (index = 0; index < last; index++) {
-		cell = getCellN(index);
-		v = cell->demiVal;
-		if (v) {
-			setCell(getCol(index), getRow(index), v, 0);
-			printf("Cell <%d,%d> set to %d\n", getCol(index) + 1, getRow(index) + 1, v);	}
-	}
-	cell = getCellN(last);
-	setCell(getCol(index), getRow(index), cell->demiVal, 1);
-	if (myGame.mode == Init) {
+	reportFilled(g, cells, numCells);
+}
+
+/*
+ * autofillAll:
+ * ------------
+ * arguments:
+ * g - the game.
+ * description:
+ * a method handling the user-command 'autofill all'.
+ * if the board is erroneous, prints an error message and returns.
+ * fills cells that have only 1 valid option until no such cell is left
+ * (a cell whose last option was taken by a peer is left empty), and
+ * reports them (reportFilled).
+ * all the cells set are recorded as a group of moves, undone and redone at once.
+ */
+void autofillAll(Game *g) {
+
+	int cells[MAX_N*MAX_N];
+	int numCells;
+
+	if (checkMemory(sudokuAutofill(g, 1, cells, &numCells)) == SudokuErroneous) {
+		printf("Error: board contains erroneous values\n");
 		return;
 	}
-	printf("Cell <%d,%d> set to %d\n", getCol(index) + 1, getRow(index) + 1, cell->demiVal);
-	printgb();
+	reportFilled(g, cells, numCells);
 }
 
 /*
  * reset:
  * ------
  * arguments:
- * none.
+ * g - the game.
  * description:
- * undoes all the moves done by the user, and clears the moves-list.
+ * undoes all the moves done by the user, and clears the moves-list
+ * (see sudokuReset).
  */
-void reset(void) {
-
-	while (myGame.currMove != myGame.sentinel) {
-		undoAny();
-	}
+void reset(Game *g) {
 
-	clearNextMoves();
+	sudokuReset(g);
 
 	printf("Board reset\n");
 
 }
 
+/*
+ * printHash:
+ * ----------
+ * arguments:
+ * g - the game.
+ * description:
+ * a method handling the (debug) user-command 'board_hash'.
+ * prints the Zobrist hash of the board (boardHash).
+ */
+void printHash(Game *g) {
+	BoardHash h = boardHash(g);
+	printf("Board hash: %08lx%08lx\n", h.hi, h.lo);
+}
+
 /*
  * exitGame:
  * ---------
  * arguments:
- * none.
+ * g - the game.
  * description:
  * a method handling the user-command 'exit', or EOF.
  * frees all memory, prints an exit message to the user,
  * and closes the game.
  */
-void exitGame(void) {
+void exitGame(Game *g) {
 
 	/*free all memory*/
 
-	while (myGame.currMove != myGame.sentinel) {
-		undoAny();
-	}
-	clearNextMoves();
-	free(myGame.sentinel);
-	free(myGame.board);
+	freeGame(g);
+	ILPcleanup();
+	freeGridPools();
 
 	/*print & exit*/
 
@@ -655,7 +637,7 @@ void exitGame(void) {
 
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
- *                    2. GAME FLOW FUNCTION                        *
+ *                    3. GAME FLOW FUNCTION                        *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 
@@ -666,7 +648,8 @@ void exitGame(void) {
  * none.
  * description:
  * a loop that handles the game flow.
- * starts the game.
+ * starts the game, on the console's game (myGame), with random
+ * numbers seeded by the time.
  * prints game-flow-related messages to the user.
  * while the game is not closed:
  *      reads input from the user and sends it to the
@@ -677,8 +660,8 @@ void gameLoop () {
 	char input[256];
 	int i;
 
-	myGame.mode = Init;
-	myGame.markErrors = 1;
+	initGame(&myGame);
+	seedGame(&myGame, (unsigned long)time(NULL));
 
 	printf("Sudoku\n------\n");
 
@@ -688,7 +671,7 @@ void gameLoop () {
 			input[i] = 0;
 		}
 		fgets(input, 256, stdin);
-		parseGameLoop(input);
+		parseGameLoop(&myGame, input);
 	}
 
 }
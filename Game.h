@@ -7,20 +7,25 @@
 #ifndef GAME_H_
 #define GAME_H_
 
-void solve(char *file_name);
-void edit(void);
-void edit1(char *file_name);
-void set(int n1,int n2,int n3);
-void validate(void);
-void generate(int x,int y);
-void undo(void);
-void redo(void);
-void save(char* address);
-void hint(int col, int row);
-void numSolutions(void);
-void autofill(void);
-void reset(void);
-void exitGame(void);
+void solve(Game *g, char *file_name);
+void edit(Game *g);
+void edit1(Game *g, char *file_name);
+void set(Game *g, int n1,int n2,int n3);
+void validate(Game *g);
+void generate(Game *g, int x,int y);
+void generateUnique(Game *g, int target);
+void undo(Game *g);
+void redo(Game *g);
+void jump(Game *g, int k);
+void save(Game *g, char* address);
+void hint(Game *g, int col, int row);
+void numSolutions(Game *g, int numThreads);
+void checkUnique(Game *g);
+void printHash(Game *g);
+void autofill(Game *g);
+void autofillAll(Game *g);
+void reset(Game *g);
+void exitGame(Game *g);
 void gameLoop ();
 
 
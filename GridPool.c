@@ -0,0 +1,201 @@
+/*
+ * GridPool.c
+ *
+ * this file implements the grid pool, which derives new solved grids without
+ * running a solver. for every block size, a pool of a few solved grids is built
+ * once, the first time a grid of that size is needed. a new grid is then
+ * derived from a random pool grid in O(N*N), by transforms that keep every
+ * grid valid:
+ * - relabeling the digits.
+ * - permuting the rows within every band (a row of blocks), and the bands.
+ * - permuting the columns within every stack (a column of blocks), and the stacks.
+ * - transposing the grid, when the blocks are square.
+ * the pools are shared by all the games, and guarded by a lock, so games
+ * can generate from different threads. the random choices are drawn from
+ * the random state of the game that asks for a grid (see nextRandom).
+ * contents:
+ * 1. pool functions - findPool (private), freeGridPools (public).
+ * 2. transform functions - groupMap (private), deriveGrid (public).
+ *
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include "DataStructures.h"
+#include "AuxMethods.h"
+#include "Solver.h"
+#include "Sudoku.h"
+#include "GridPool.h"
+
+#define POOL_SIZE 8 /*number of grids solved for every block size*/
+
+GridPool *gridPools = NULL; /*the pools of all the block sizes used so far*/
+pthread_mutex_t gridPoolsLock = PTHREAD_MUTEX_INITIALIZER; /*guards gridPools*/
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                            1. POOLS                             *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * findPool:
+ * ---------
+ * arguments:
+ * rng - a random state (see nextRandom).
+ * blockW - block width.
+ * blockH - block height.
+ * description:
+ * returns the pool of the requested block size. if there is none yet,
+ * creates it, and fills it with POOL_SIZE random solved grids.
+ * returns NULL if there is not enough memory for a new pool.
+ * a pool is never changed once it is filled, so it can be read without
+ * the lock; only the list of pools is locked.
+ */
+GridPool *findPool(unsigned long *rng, int blockW, int blockH) {
+	GridPool *pool;
+	SolverState s;
+	int g, n, N = blockW*blockH;
+
+	pthread_mutex_lock(&gridPoolsLock);
+	for (pool = gridPools; pool != NULL; pool = pool->next) {
+		if (pool->blockW == blockW && pool->blockH == blockH) {
+			pthread_mutex_unlock(&gridPoolsLock);
+			return pool;
+		}
+	}
+
+	pool = malloc(sizeof(GridPool));
+	if (pool != NULL) {
+		pool->grids = malloc(POOL_SIZE*N*N*sizeof(int));
+	}
+	if (pool == NULL || pool->grids == NULL || !createSolver(&s, blockW, blockH)) {
+		if (pool != NULL) {
+			free(pool->grids);
+		}
+		free(pool);
+		pthread_mutex_unlock(&gridPoolsLock);
+		return NULL;
+	}
+	pool->blockW = blockW;
+	pool->blockH = blockH;
+	pool->numGrids = 0;
+
+	/*solve the empty board with random value ordering, for different grids*/
+	for (g = 0; g < POOL_SIZE; g++) {
+		clearSolver(&s);
+		if (!findRandomSolution(&s, rng)) {
+			continue;
+		}
+		for (n = 0; n < N*N; n++) {
+			pool->grids[pool->numGrids*N*N + n] = s.vals[n];
+		}
+		pool->numGrids++;
+	}
+	freeSolver(&s);
+
+	/*the pool is listed only once it is full*/
+	pool->next = gridPools;
+	gridPools = pool;
+	pthread_mutex_unlock(&gridPoolsLock);
+	return pool;
+}
+
+/*
+ * freeGridPools:
+ * --------------
+ * arguments:
+ * none.
+ * description:
+ * frees the pools of all the block sizes.
+ * to be called once no game is generating.
+ */
+void freeGridPools(void) {
+	GridPool *next;
+	pthread_mutex_lock(&gridPoolsLock);
+	while (gridPools != NULL) {
+		next = gridPools->next;
+		free(gridPools->grids);
+		free(gridPools);
+		gridPools = next;
+	}
+	pthread_mutex_unlock(&gridPoolsLock);
+}
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                          2. TRANSFORMS                          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * groupMap:
+ * ---------
+ * arguments:
+ * rng - a random state (see nextRandom).
+ * map - an array of groupSize*numGroups ints.
+ * groupSize - the number of lines (rows or columns) in a group (band or stack).
+ * numGroups - the number of groups.
+ * description:
+ * fills 'map' with a random permutation of the lines that keeps every group
+ * together: the groups are permuted, and so are the lines within every group.
+ * line i of the new grid is line map[i] of the old one.
+ */
+void groupMap(unsigned long *rng, int *map, int groupSize, int numGroups) {
+	int g, i, groups[MAX_N], lines[MAX_N];
+	shuffleCells(rng, groups, numGroups, numGroups);
+	for (g = 0; g < numGroups; g++) {
+		shuffleCells(rng, lines, groupSize, groupSize);
+		for (i = 0; i < groupSize; i++) {
+			map[g*groupSize + i] = groups[g]*groupSize + lines[i];
+		}
+	}
+}
+
+/*
+ * deriveGrid:
+ * -----------
+ * arguments:
+ * g - the game.
+ * grid - an array of N*N ints.
+ * description:
+ * fills 'grid' with a random solved grid of the game's block size,
+ * derived from a pool grid by random symmetry transforms, which are
+ * drawn from the game's random state.
+ * returns SudokuOk on success, SudokuGeneratorFailed if the pool is empty,
+ * and SudokuOutOfMemory if there is not enough memory for the pool.
+ */
+int deriveGrid(Game *g, int *grid) {
+	int blockW = g->blockW, blockH = g->blockH;
+	GridPool *pool = findPool(&g->rng, blockW, blockH);
+	int N = blockW*blockH, row, col, r, c, tmp, transpose, *base;
+	int relabel[MAX_N], rowMap[MAX_N], colMap[MAX_N];
+
+	if (pool == NULL) {
+		return SudokuOutOfMemory;
+	}
+	if (pool->numGrids == 0) {
+		return SudokuGeneratorFailed;
+	}
+	base = pool->grids + randInt(&g->rng, pool->numGrids)*N*N;
+
+	/*rows come in bands of blockH rows, and columns in stacks of blockW columns*/
+	shuffleCells(&g->rng, relabel, N, N);
+	groupMap(&g->rng, rowMap, blockH, blockW);
+	groupMap(&g->rng, colMap, blockW, blockH);
+	transpose = (blockW == blockH) && randInt(&g->rng, 2);
+
+	for (row = 0; row < N; row++) {
+		for (col = 0; col < N; col++) {
+			r = rowMap[row];
+			c = colMap[col];
+			if (transpose) {
+				tmp = r;
+				r = c;
+				c = tmp;
+			}
+			grid[row*N + col] = relabel[base[r*N + c] - 1] + 1;
+		}
+	}
+	return SudokuOk;
+}
@@ -0,0 +1,13 @@
+/*
+ * GridPool.h
+ *
+ * this file allows other modules to use the grid pool.
+ */
+
+#ifndef GRIDPOOL_H_
+#define GRIDPOOL_H_
+
+void freeGridPools(void);
+int deriveGrid(Game *g, int *grid);
+
+#endif /* GRIDPOOL_H_ */
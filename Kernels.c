@@ -0,0 +1,237 @@
+/*
+ * Kernels.c
+ *
+ * this file implements the unit kernels, which work on a whole unit
+ * (a row, a column or a block of a game's board) at once:
+ * - unitCandidates computes the candidates mask of every cell in a unit.
+ * - unitMatches finds the cells of a unit that hold a given value.
+ * units are numbered as in the rest of the code: rows are 0 to N-1,
+ * columns are N to 2N-1, and blocks are 2N to 3N-1. the i'th cell of a
+ * block is counted left to right, then top to bottom.
+ * when compiled with AVX2 (make USE_AVX2=1), the kernels handle 8 cells per
+ * instruction, gathering the masks and values straight from the board (the
+ * values are bytes, so 4 bytes are gathered per cell and the 3 extra are
+ * masked off; the board is padded for the last cell).
+ * otherwise, on SSE2 machines, which have no gather, only what is contiguous
+ * in memory is loaded as a vector: unitCandidates ORs 4 cells at a time, with
+ * the mask of the unit itself broadcast, and the masks of the crossing columns
+ * (of a row) or rows (of a column) loaded as they are, so only the remaining
+ * masks are collected one by one; unitMatches compares the values of a row 16
+ * bytes at a time, but the values of a column or a block are collected into
+ * a buffer first. on any other machine the kernels fall back to plain loops.
+ * contents:
+ * 1. unit layout functions - unitCell, unitPosition, createUnitLayouts. (public)
+ * 2. kernel functions - unitCandidates, unitMatches. (public)
+ *
+ */
+
+#include "DataStructures.h"
+#include "AuxMethods.h"
+#include "Kernels.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define KERNEL_LANES 8
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define KERNEL_LANES 4
+#define BYTE_LANES 16 /*values compared per instruction by unitMatches*/
+#else
+#define KERNEL_LANES 1
+#endif
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                         1. UNIT LAYOUT                          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * unitCell:
+ * ---------
+ * arguments:
+ * g - the game.
+ * unit - a unit number.
+ * i - the position of a cell within the unit (0 to N-1).
+ * description:
+ * returns the number (left to right, then top to bottom) of the
+ * i'th cell in 'unit'.
+ */
+int unitCell(Game *g, int unit, int i) {
+	int N = g->N, u = unit%N, bw = g->blockW, bh = g->blockH;
+	if (unit < N) {
+		return getN(g, i, u);
+	}
+	if (unit < 2*N) {
+		return getN(g, u, i);
+	}
+	return getN(g, (u%bh)*bw + i%bw, (u/bh)*bh + i/bw);
+}
+
+/*
+ * unitPosition:
+ * -------------
+ * arguments:
+ * g - the game.
+ * unit - a unit number.
+ * col - column of a cell in 'unit'.
+ * row - row of a cell in 'unit'.
+ * description:
+ * returns the position of cell <col,row> within 'unit' (see unitCell).
+ */
+int unitPosition(Game *g, int unit, int col, int row) {
+	int N = g->N;
+	if (unit < N) {
+		return col;
+	}
+	if (unit < 2*N) {
+		return row;
+	}
+	return (row%g->blockH)*g->blockW + col%g->blockW;
+}
+
+/*
+ * createUnitLayouts:
+ * ------------------
+ * arguments:
+ * g - the game, with its unit tables allocated (see createGame).
+ * description:
+ * lists the cells of every unit in g->unitCells, and their rows, columns
+ * and blocks in g->unitRows, g->unitCols and g->unitBlocks, so the kernels
+ * load them instead of dividing on every call. each unit takes UNIT_PAD
+ * entries, and the positions after the N'th are padded with cell 0, so
+ * the kernels can always work on whole vectors.
+ * to be called once per board, by createGame.
+ */
+void createUnitLayouts(Game *g) {
+	int unit, i, k, N = g->N;
+	for (unit = 0; unit < 3*N; unit++) {
+		for (i = 0; i < UNIT_PAD; i++) {
+			k = unit*UNIT_PAD + i;
+			g->unitCells[k] = (i < N) ? unitCell(g, unit, i) : 0;
+			g->unitRows[k] = getRow(g, g->unitCells[k]);
+			g->unitCols[k] = getCol(g, g->unitCells[k]);
+			g->unitBlocks[k] = getBlock(g, g->unitCols[k], g->unitRows[k]);
+		}
+	}
+}
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                           2. KERNELS                            *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * unitCandidates:
+ * ---------------
+ * arguments:
+ * g - the game.
+ * unit - a unit number.
+ * cands - an array of at least UNIT_PAD masks.
+ * description:
+ * sets cands[i] to the mask of the values that are not used in the row,
+ * column or block of the i'th cell of 'unit' (the same as getCandidates).
+ * the masks are computed for filled cells as well; the caller decides
+ * which cells it cares about.
+ */
+void unitCandidates(Game *g, int unit, unsigned int *cands) {
+	const int *rows = g->unitRows + unit*UNIT_PAD, *cols = g->unitCols + unit*UNIT_PAD,
+		*blocks = g->unitBlocks + unit*UNIT_PAD;
+	unsigned int full = (1u << g->N) - 1;
+	int i = 0;
+#if KERNEL_LANES == 4
+	int N = g->N;
+	const unsigned int *cross = (unit < N) ? g->colMask : g->rowMask;
+	unsigned int own = (unit < N) ? g->rowMask[unit] : (unit < 2*N) ? g->colMask[unit - N] : g->blockMask[unit - 2*N];
+	__m128i vfull = _mm_set1_epi32((int)full), vused;
+#elif KERNEL_LANES == 8
+	__m256i vfull = _mm256_set1_epi32((int)full), vused;
+#endif
+
+#if KERNEL_LANES == 8
+	/*gather the three masks of 8 cells at once*/
+	for (; i < g->N; i += 8) {
+		vused = _mm256_or_si256(
+				_mm256_i32gather_epi32((const int *)g->rowMask, _mm256_loadu_si256((__m256i *)(rows + i)), 4),
+				_mm256_i32gather_epi32((const int *)g->colMask, _mm256_loadu_si256((__m256i *)(cols + i)), 4));
+		vused = _mm256_or_si256(vused,
+				_mm256_i32gather_epi32((const int *)g->blockMask, _mm256_loadu_si256((__m256i *)(blocks + i)), 4));
+		_mm256_storeu_si256((__m256i *)(cands + i), _mm256_andnot_si256(vused, vfull));
+	}
+#elif KERNEL_LANES == 4
+	/*the cells of a unit share its own mask. the cells of a row (column) cross the
+	  columns (rows) in order, so their masks are loaded as they are (the masks are
+	  padded to UNIT_PAD), and only the masks of the blocks are collected*/
+	for (; i < N; i += 4) {
+		vused = _mm_set1_epi32((int)own);
+		if (unit < 2*N) {
+			vused = _mm_or_si128(vused, _mm_loadu_si128((__m128i *)(cross + i)));
+			vused = _mm_or_si128(vused, _mm_set_epi32((int)g->blockMask[blocks[i + 3]], (int)g->blockMask[blocks[i + 2]],
+					(int)g->blockMask[blocks[i + 1]], (int)g->blockMask[blocks[i]]));
+		} else {
+			vused = _mm_or_si128(vused, _mm_set_epi32((int)g->rowMask[rows[i + 3]], (int)g->rowMask[rows[i + 2]],
+					(int)g->rowMask[rows[i + 1]], (int)g->rowMask[rows[i]]));
+			vused = _mm_or_si128(vused, _mm_set_epi32((int)g->colMask[cols[i + 3]], (int)g->colMask[cols[i + 2]],
+					(int)g->colMask[cols[i + 1]], (int)g->colMask[cols[i]]));
+		}
+		_mm_storeu_si128((__m128i *)(cands + i), _mm_andnot_si128(vused, vfull));
+	}
+#else
+	for (; i < g->N; i++) {
+		cands[i] = ~(g->rowMask[rows[i]] | g->colMask[cols[i]] | g->blockMask[blocks[i]]) & full;
+	}
+#endif
+}
+
+/*
+ * unitMatches:
+ * ------------
+ * arguments:
+ * g - the game.
+ * unit - a unit number.
+ * val - a cell value (0 for empty cells).
+ * description:
+ * returns a mask in which bit i is set iff the i'th cell of 'unit' holds 'val'.
+ */
+unsigned int unitMatches(Game *g, int unit, int val) {
+	const int *cells = g->unitCells + unit*UNIT_PAD;
+	unsigned int matches = 0;
+	int i = 0;
+#if KERNEL_LANES == 4
+	const unsigned char *vals = g->vals + unit*g->N;
+	unsigned char buffer[UNIT_PAD];
+	__m128i vval = _mm_set1_epi8((char)val);
+#elif KERNEL_LANES == 8
+	__m256i vval = _mm256_set1_epi32(val), low = _mm256_set1_epi32(0xFF);
+#endif
+
+#if KERNEL_LANES == 8
+	/*gather the values of 8 cells at once, straight from the board*/
+	for (; i < g->N; i += 8) {
+		matches |= (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(
+				_mm256_i32gather_epi32((const int *)g->vals, _mm256_loadu_si256((__m256i *)(cells + i)), 1),
+				low), vval))) << i;
+	}
+#elif KERNEL_LANES == 4
+	/*the values of a row are contiguous on the board (which is padded after the
+	  last row), the values of a column or a block are copied to a buffer first*/
+	if (unit >= g->N) {
+		for (i = 0; i < g->N; i++) {
+			buffer[i] = g->vals[cells[i]];
+		}
+		vals = buffer;
+	}
+	for (i = 0; i < g->N; i += BYTE_LANES) {
+		matches |= (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(
+				_mm_loadu_si128((__m128i *)(vals + i)), vval)) << i;
+	}
+#else
+	for (; i < g->N; i++) {
+		if (g->vals[cells[i]] == val) {
+			matches |= 1u << i;
+		}
+	}
+#endif
+	return matches & ((1u << g->N) - 1);
+}
@@ -0,0 +1,18 @@
+/*
+ * Kernels.h
+ *
+ * this file allows other modules to use the unit kernels.
+ */
+
+#ifndef KERNELS_H_
+#define KERNELS_H_
+
+#define UNIT_PAD 32 /*N is at most 25, so a unit padded to 32 cells fits whole vectors*/
+
+int unitCell(Game *g, int unit, int i);
+int unitPosition(Game *g, int unit, int col, int row);
+void createUnitLayouts(Game *g);
+void unitCandidates(Game *g, int unit, unsigned int *cands);
+unsigned int unitMatches(Game *g, int unit, int val);
+
+#endif /* KERNELS_H_ */
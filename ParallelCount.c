@@ -0,0 +1,371 @@
+/*
+ * ParallelCount.c
+ *
+ * this file implements the parallel solution counter.
+ * the search tree is split at a shallow depth into subproblems (tasks), each
+ * one a short list of values to place on top of the board. every worker thread
+ * gets an equal share of the tasks in its own deque. a worker takes tasks from
+ * the front of its deque, and when it runs out it steals from the back of
+ * other workers' deques, until no tasks are left. every worker counts with its
+ * own SolverState, and the per-worker counters are summed at the end.
+ * the task and worker structs are kept in this file, since they depend
+ * on pthreads.
+ * contents:
+ * 1. task-splitting functions. (private)
+ * 2. worker functions. (private)
+ * 3. parallel counting functions - getNumCores, countParallel. (public)
+ *
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include "DataStructures.h"
+#include "AuxMethods.h"
+#include "Solver.h"
+#include "ParallelCount.h"
+
+#define TASKS_PER_WORKER 32 /*split until there are this many tasks per worker*/
+
+/*
+ * TaskList:
+ * ---------
+ * a list of subproblems that all place the same number of values.
+ */
+typedef struct
+{
+	int
+		numTasks,
+		depth, /*number of values every task places*/
+		*placements; /*task t places value placements[2*(depth*t + i) + 1] in cell placements[2*(depth*t + i)]*/
+} TaskList;
+
+/*
+ * Worker:
+ * -------
+ * a counting thread, and the deque of tasks it owns.
+ */
+typedef struct Worker
+{
+	pthread_t thread;
+	pthread_mutex_t lock; /*guards first and last*/
+	int
+		first, /*the tasks in the deque are first to last-1*/
+		last,
+		numWorkers,
+		started; /*whether a thread was started for this worker*/
+	long counter;
+	SolverState s;
+	TaskList *tasks;
+	struct Worker *workers; /*all the workers, for stealing*/
+} Worker;
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                       1. TASK SPLITTING                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * applyTask:
+ * ----------
+ * arguments:
+ * s - the state.
+ * tasks - the task list.
+ * t - the number of the task.
+ * description:
+ * places the values of task t in 's'.
+ */
+void applyTask(SolverState *s, TaskList *tasks, int t) {
+	int i, *p = tasks->placements + 2*tasks->depth*t;
+	for (i = 0; i < tasks->depth; i++) {
+		setSolverValue(s, p[2*i], p[2*i + 1]);
+	}
+}
+
+/*
+ * revertTask:
+ * -----------
+ * arguments:
+ * s - the state.
+ * tasks - the task list.
+ * t - the number of the task.
+ * description:
+ * removes the values of task t from 's'.
+ */
+void revertTask(SolverState *s, TaskList *tasks, int t) {
+	int i, *p = tasks->placements + 2*tasks->depth*t;
+	for (i = tasks->depth - 1; i >= 0; i--) {
+		unsetSolverValue(s, p[2*i]);
+	}
+}
+
+/*
+ * expandTasks:
+ * ------------
+ * arguments:
+ * s - the state of the board being counted.
+ * from - the current task list.
+ * to - the list to fill with the tasks one level deeper.
+ * solved - a counter for the solutions found while splitting.
+ * description:
+ * replaces every task in 'from' by one task for every candidate of the
+ * cell with the fewest candidates. a task that fills the board is a
+ * solution, and is added to 'solved' instead.
+ * returns 1 on success, and 0 if there is not enough memory for 'to'
+ * (then 'solved' is not changed).
+ */
+int expandTasks(SolverState *s, TaskList *from, TaskList *to, long *solved) {
+	int t, i, n, val, *p, *q;
+	unsigned int cands, bit;
+
+	to->numTasks = 0;
+	to->depth = from->depth + 1;
+	to->placements = malloc(2*to->depth*from->numTasks*s->N*sizeof(int));
+	if (to->placements == NULL) {
+		return 0;
+	}
+	for (t = 0; t < from->numTasks; t++) {
+		applyTask(s, from, t);
+		cands = chooseCell(s, 0);
+		n = s->empty[0];
+		for (val = 1, bit = 1u; cands; val++, bit <<= 1) {
+			if (!(cands & bit)) {
+				continue;
+			}
+			cands &= ~bit;
+			if (s->numEmpty == 1) {
+				(*solved)++;
+				continue;
+			}
+			p = from->placements + 2*from->depth*t;
+			q = to->placements + 2*to->depth*to->numTasks;
+			for (i = 0; i < 2*from->depth; i++) {
+				q[i] = p[i];
+			}
+			q[2*from->depth] = n;
+			q[2*from->depth + 1] = val;
+			to->numTasks++;
+		}
+		revertTask(s, from, t);
+	}
+	return 1;
+}
+
+/*
+ * splitTasks:
+ * -----------
+ * arguments:
+ * s - the state of the board being counted (with at least one empty cell).
+ * tasks - the list to fill.
+ * target - the number of tasks to aim for.
+ * solved - a counter for the solutions found while splitting.
+ * description:
+ * splits the search tree of 's' level by level, until there are at least
+ * 'target' tasks, or no tasks are left.
+ * returns 1 on success, and 0 if there is not enough memory (then nothing
+ * is left allocated, and 'solved' is not changed).
+ */
+int splitTasks(SolverState *s, TaskList *tasks, int target, long *solved) {
+	TaskList next;
+	long found = 0;
+	tasks->numTasks = 1;
+	tasks->depth = 0;
+	tasks->placements = malloc(sizeof(int));
+	if (tasks->placements == NULL) {
+		return 0;
+	}
+	while (tasks->numTasks > 0 && tasks->numTasks < target) {
+		if (!expandTasks(s, tasks, &next, &found)) {
+			free(tasks->placements);
+			return 0;
+		}
+		free(tasks->placements);
+		*tasks = next;
+	}
+	*solved += found;
+	return 1;
+}
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                           2. WORKERS                            *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * takeTask:
+ * ---------
+ * arguments:
+ * w - the worker looking for a task.
+ * description:
+ * takes a task from the front of w's deque. if it is empty,
+ * steals a task from the back of another worker's deque.
+ * returns the task's number, or -1 if there are no tasks left.
+ */
+int takeTask(Worker *w) {
+	int i, t = -1;
+	Worker *v;
+
+	pthread_mutex_lock(&w->lock);
+	if (w->first < w->last) {
+		t = w->first++;
+	}
+	pthread_mutex_unlock(&w->lock);
+
+	/*steal*/
+	for (i = 1; t < 0 && i < w->numWorkers; i++) {
+		v = w->workers + ((w - w->workers) + i)%w->numWorkers;
+		pthread_mutex_lock(&v->lock);
+		if (v->first < v->last) {
+			t = --v->last;
+		}
+		pthread_mutex_unlock(&v->lock);
+	}
+	return t;
+}
+
+/*
+ * runWorker:
+ * ----------
+ * arguments:
+ * arg - the Worker running this function.
+ * description:
+ * counts the solutions of tasks until none are left,
+ * adding them to the worker's counter.
+ */
+void *runWorker(void *arg) {
+	Worker *w = arg;
+	int t;
+	while ((t = takeTask(w)) >= 0) {
+		applyTask(&w->s, w->tasks, t);
+		w->counter += countSolutions(&w->s);
+		revertTask(&w->s, w->tasks, t);
+	}
+	return NULL;
+}
+
+/*
+ * createWorkerStates:
+ * -------------------
+ * arguments:
+ * workers - an array of 'numWorkers' workers.
+ * numWorkers - the number of workers.
+ * s - the state of the board being counted.
+ * description:
+ * creates the solver state of every worker, with the dimensions of 's'.
+ * returns 1 on success, and 0 if there is not enough memory (then no
+ * state is left allocated).
+ */
+int createWorkerStates(Worker *workers, int numWorkers, SolverState *s) {
+	int i;
+	for (i = 0; i < numWorkers; i++) {
+		if (!createSolver(&workers[i].s, s->blockW, s->blockH)) {
+			while (--i >= 0) {
+				freeSolver(&workers[i].s);
+			}
+			return 0;
+		}
+	}
+	return 1;
+}
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                     3. PARALLEL COUNTING                        *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * getNumCores:
+ * ------------
+ * arguments:
+ * none.
+ * description:
+ * returns the number of online processors (at most MAX_THREADS).
+ */
+int getNumCores(void) {
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	if (cores < 1) {
+		return 1;
+	}
+	if (cores > MAX_THREADS) {
+		return MAX_THREADS;
+	}
+	return (int)cores;
+}
+
+/*
+ * countParallel:
+ * --------------
+ * arguments:
+ * s - a state loaded with a board that has no erroneous values.
+ * numThreads - the number of threads to count with (1 to MAX_THREADS).
+ * threadsUsed - set to the number of threads that counted.
+ * description:
+ * returns the number of solutions of the board in 's', which is the same
+ * as countSolutions(s), counted by 'numThreads' work-stealing workers.
+ * the calling thread is one of the workers.
+ * if there is not enough memory for the tasks or the workers, the calling
+ * thread counts alone (countSolutions needs no memory of its own), and if a
+ * thread can't be started, the others count for it. either way, fewer than
+ * 'numThreads' threads are reported in 'threadsUsed' (a full board, which
+ * has nothing to split, is reported as counted by all of them).
+ * the board in 's' is left as it was.
+ */
+long countParallel(SolverState *s, int numThreads, int *threadsUsed) {
+	TaskList tasks;
+	Worker *workers;
+	long counter = 0;
+	int i, share;
+
+	*threadsUsed = numThreads;
+	if (numThreads <= 1 || s->numEmpty == 0) {
+		return countSolutions(s);
+	}
+	*threadsUsed = 1;
+
+	/*split the search tree, and deal the tasks to the workers*/
+	if (!splitTasks(s, &tasks, TASKS_PER_WORKER*numThreads, &counter)) {
+		return countSolutions(s);
+	}
+	workers = malloc(numThreads*sizeof(Worker));
+	if (workers == NULL || !createWorkerStates(workers, numThreads, s)) {
+		free(workers);
+		free(tasks.placements);
+		return countSolutions(s);
+	}
+	share = (tasks.numTasks + numThreads - 1)/numThreads;
+	for (i = 0; i < numThreads; i++) {
+		pthread_mutex_init(&workers[i].lock, NULL);
+		workers[i].first = (i*share < tasks.numTasks) ? i*share : tasks.numTasks;
+		workers[i].last = ((i + 1)*share < tasks.numTasks) ? (i + 1)*share : tasks.numTasks;
+		workers[i].numWorkers = numThreads;
+		workers[i].counter = 0;
+		workers[i].tasks = &tasks;
+		workers[i].workers = workers;
+		copySolver(&workers[i].s, s);
+	}
+
+	/*start the workers. if a thread can't be started, its tasks get stolen*/
+	for (i = 1; i < numThreads; i++) {
+		workers[i].started = !pthread_create(&workers[i].thread, NULL, runWorker, workers + i);
+		*threadsUsed += workers[i].started;
+	}
+	runWorker(workers);
+
+	/*wait for the workers, and sum their counters*/
+	for (i = 0; i < numThreads; i++) {
+		if (i > 0 && workers[i].started) {
+			pthread_join(workers[i].thread, NULL);
+		}
+		counter += workers[i].counter;
+		pthread_mutex_destroy(&workers[i].lock);
+		freeSolver(&workers[i].s);
+	}
+	free(workers);
+	free(tasks.placements);
+	return counter;
+}
@@ -0,0 +1,17 @@
+/*
+ * ParallelCount.h
+ *
+ * this file allows other modules to use the parallel solution counter.
+ */
+
+#ifndef PARALLELCOUNT_H_
+#define PARALLELCOUNT_H_
+
+#include "DataStructures.h"
+
+#define MAX_THREADS 64 /*the maximal number of counting threads*/
+
+int getNumCores(void);
+long countParallel(SolverState *s, int numThreads, int *threadsUsed);
+
+#endif /* PARALLELCOUNT_H_ */
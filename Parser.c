@@ -16,9 +16,11 @@
 #include <string.h>
 #include <stdlib.h>
 #include "AuxMethods.h"
+#include "Console.h"
 #include "DataStructures.h"
 #include "Game.h"
 #include "Parser.h"
+#include "ParallelCount.h"
 
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -29,6 +31,7 @@
 /* caseSolve:
  * ----------
  * arguments:
+ * g - the game.
  * token - a string to be parsed.
  * description:
  * parses input farther, if the first few characters in the input,
@@ -38,7 +41,7 @@
  * if the input specifies a valid command, calls the function handling the command,
  * and passing the parsed arguments.
  */
-void caseSolve(char * token){
+void caseSolve(Game *g, char * token){
 
 	int i;
 	char * n = 0;
@@ -53,13 +56,14 @@ void caseSolve(char * token){
 	if (i<1) {
 		printf("ERROR: invalid command\n");
 		return;	}
-	solve(n);
+	solve(g, n);
 	return;
 }
 
 /* caseEdit:
  * ---------
  * arguments:
+ * g - the game.
  * token - a string to be parsed.
  * description:
  * parses input farther, if the first few characters in the input,
@@ -69,17 +73,18 @@ void caseSolve(char * token){
  * if the input specifies a valid command, calls the function handling the command,
  * and passing the parsed arguments.
  */
-void caseEdit(char * token){
+void caseEdit(Game *g, char * token){
 	token = strtok(NULL, " \r\t\n");
 	if (token == NULL)
-		edit();
+		edit(g);
 	else
-		edit1(token);
+		edit1(g, token);
 	return;}
 
 /* caseMarkErrors:
  * ---------------
  * arguments:
+ * g - the game.
  * token - a string to be parsed.
  * description:
  * parses input farther, if the first few characters in the input,
@@ -89,9 +94,9 @@ void caseEdit(char * token){
  * if the input specifies a valid command, calls the function handling the command,
  * and passing the parsed arguments.
  */
-void caseMarkErrors(char * token){
+void caseMarkErrors(Game *g, char * token){
 	int mark;
-	if (myGame.mode != Solve) {
+	if (g->mode != Solve) {
 		printf("ERROR: invalid command\n");
 		return;}
 	token = strtok(NULL, " \r\t\n");
@@ -103,32 +108,33 @@ void caseMarkErrors(char * token){
 		printf("Error: the value should be 0 or 1\n");
 		return;
 	}
-	myGame.markErrors = mark;
+	g->markErrors = mark;
 	return;
 }
 
 /* casePrintBoard:
  * ---------------
  * arguments:
- * none.
+ * g - the game.
  * description:
  * parses input farther, if the first few characters in the input,
  * specify the case 'print_board'.
  * if input is misformatted prints an error message.
  * if the input specifies a valid command, calls the function handling the command.
  */
-void casePrintBoard(){
-	if (myGame.mode == Init) {
+void casePrintBoard(Game *g){
+	if (g->mode == Init) {
 		printf("ERROR: invalid command\n");
 		return;}
 	else {
-		printgb();
+		printgb(g);
 		return;	}
 }
 
 /* caseSet:
  * --------
  * arguments:
+ * g - the game.
  * token - a string to be parsed.
  * description:
  * parses input farther, if the first few characters in the input,
@@ -138,9 +144,9 @@ void casePrintBoard(){
  * if the input specifies a valid command, calls the function handling the command,
  * and passing the parsed arguments.
  */
-void caseSet(char * token){
+void caseSet(Game *g, char * token){
 	int i, f1, f2, f3, n1, n2, n3;
-	if (myGame.mode == Init)
+	if (g->mode == Init)
 		printf("ERROR: invalid command\n");
 	else{
 		/*find out whether there are 3 valid int arguments*/
@@ -153,34 +159,34 @@ void caseSet(char * token){
 					f1 = isNum(token);
 					if (f1){
 						n1 = atoi(token);
-						f1 = ((n1>0) && (n1<=myGame.N));
+						f1 = ((n1>0) && (n1<=g->N));
 					}
 				}
 				if (i==2){
 					f2 = isNum(token);
 					if (f2){
 						n2 = atoi(token);
-						f2 = ((n2>0) && (n2<=myGame.N));
+						f2 = ((n2>0) && (n2<=g->N));
 					}
 				}
 				if (i==3){
 					f3 = isNum(token);
 					if (f3){
 						n3 = atoi(token);
-						f3 = ((n3>=0) && (n3<=myGame.N));
+						f3 = ((n3>=0) && (n3<=g->N));
 					}
 					break;
 				}
 			}
 		}
 		if ( i == 3 && (!f1 || !f2 || !f3)) { /*i indicates number of arguments, and f1-3 tell whether they are ints*/
-			printf("Error: value not in range 0-%d\n",myGame.N);
+			printf("Error: value not in range 0-%d\n",g->N);
 			return;	}
 		if ((i<3)) {
 			printf("Error: invalid command\n");
 			return;	}
 		else {
-			set(n1,n2,n3);
+			set(g, n1,n2,n3);
 			return;	}
 	}
 	return;
@@ -189,25 +195,26 @@ void caseSet(char * token){
 /* caseValidate:
  * -------------
  * arguments:
- * none.
+ * g - the game.
  * description:
  * parses input farther, if the first few characters in the input,
  * specify the case 'validate'.
  * if input is misformatted prints an error message.
  * if the input specifies a valid command, calls the function handling the command.
  */
-void caseValidate(){
-	if (myGame.mode == Init) {
+void caseValidate(Game *g){
+	if (g->mode == Init) {
 		printf("ERROR: invalid command\n");
 		return;}
 	else {
-		validate();
+		validate(g);
 		return;}
 }
 
 /* caseGenerate:
  * -------------
  * arguments:
+ * g - the game.
  * token - a string to be parsed.
  * description:
  * parses input farther, if the first few characters in the input,
@@ -217,9 +224,9 @@ void caseValidate(){
  * if the input specifies a valid command, calls the function handling the command,
  * and passing the parsed arguments.
  */
-void caseGenerate(char * token){
+void caseGenerate(Game *g, char * token){
 	int i, f1, f2, n1, n2;
-	if (myGame.mode != Edit) {
+	if (g->mode != Edit) {
 		printf("ERROR: invalid command\n");
 		return;}
 	else{
@@ -233,72 +240,135 @@ void caseGenerate(char * token){
 					f1 = isNum(token);
 					if (f1) {
 						n1 = atoi(token);
-						f1 = ((n1>=0) && (n1<=myGame.N*myGame.N - myGame.numFilled));}
+						f1 = ((n1>=0) && (n1<=g->N*g->N - g->numFilled));}
 				}
 
 				if (i==2){
 					f2 = isNum(token);
 					if (f2) {
 						n2 = atoi(token);
-						f2 = ((n2>=0) && (n2<=myGame.N*myGame.N - myGame.numFilled));}
+						f2 = ((n2>=0) && (n2<=g->N*g->N - g->numFilled));}
 					break;
 				}
 			}
 		}
 		if (i == 2 && (!f1 || !f2)) { /*i indicates number of arguments, and f1-2 tell whether they are ints*/
-			printf("Error: value not in range 0-%d\n", myGame.N*myGame.N - myGame.numFilled);
+			printf("Error: value not in range 0-%d\n", g->N*g->N - g->numFilled);
 			return;}
 		if (i<2) {
 			printf("Error: invalid command\n");
 			return;}
 		else
-			generate(n1,n2);
+			generate(g, n1,n2);
 	}
 	return;
 }
 
+/* caseGenerateUnique:
+ * -------------------
+ * arguments:
+ * g - the game.
+ * token - a string to be parsed.
+ * description:
+ * parses input farther, if the first few characters in the input,
+ * specify the case 'generate_unique'.
+ * an optional argument sets the number of clues to stop at
+ * (by default, clues are removed until the puzzle is minimal).
+ * if input is misformatted, or if the argument is not valid,
+ * prints an error message.
+ * if the input specifies a valid command, calls the function handling the command,
+ * and passing the parsed argument.
+ */
+void caseGenerateUnique(Game *g, char * token){
+	int n = 0;
+	if (g->mode != Edit) {
+		printf("ERROR: invalid command\n");
+		return;
+	}
+	token = strtok(NULL, " \r\t\n");
+	if (token != NULL) {
+		n = isNum(token) ? atoi(token) : -1;
+		if (n < 0 || n > g->N*g->N) {
+			printf("Error: value not in range 0-%d\n", g->N*g->N);
+			return;
+		}
+	}
+	generateUnique(g, n);
+}
+
 /* caseUndo:
  * ---------
  * arguments:
- * none.
+ * g - the game.
  * description:
  * parses input farther, if the first few characters in the input,
  * specify the case 'undo'.
  * if input is misformatted prints an error message.
  * if the input specifies a valid command, calls the function handling the command.
  */
-void caseUndo(){
-	if (myGame.mode == Init) {
+void caseUndo(Game *g){
+	if (g->mode == Init) {
 		printf("ERROR: invalid command\n");
 		return;
 	}
 	else{
-		undo();
+		undo(g);
 		return;}
 }
 
 /* caseRedo:
  * ---------
  * arguments:
- * none.
+ * g - the game.
  * description:
  * parses input farther, if the first few characters in the input,
  * specify the case 'redo'.
  * if input is misformatted prints an error message.
  * if the input specifies a valid command, calls the function handling the command.
  */
-void caseRedo(){
-	if (myGame.mode == Init) {
+void caseRedo(Game *g){
+	if (g->mode == Init) {
 		printf("ERROR: invalid command\n");
 		return;}
 	else{
-		redo();
+		redo(g);
 		return;}
 }
 
+/* caseJump:
+ * ---------
+ * arguments:
+ * g - the game.
+ * token - a string to be parsed.
+ * description:
+ * parses input farther, if the first few characters in the input,
+ * specify the case 'jump'.
+ * if input is misformatted, or if the argument is not valid,
+ * prints an error message.
+ * if the input specifies a valid command, calls the function handling the command,
+ * and passing the parsed argument.
+ */
+void caseJump(Game *g, char * token){
+	if (g->mode == Init) {
+		printf("ERROR: invalid command\n");
+		return;
+	}
+	token = strtok(NULL, " \r\t\n");
+	if (token == NULL) {
+		printf("ERROR: invalid command\n");
+		return;
+	}
+	if (!isNum(token)) {
+		printf("Error: value not in range 0-%d\n", g->log.numSteps);
+		return;
+	}
+	jump(g, atoi(token));
+}
+
 /* caseSave:
  * ---------
  * arguments:
+ * g - the game.
  * token - a string to be parsed.
  * description:
  * parses input farther, if the first few characters in the input,
@@ -308,10 +378,10 @@ void caseRedo(){
  * if the input specifies a valid command, calls the function handling the command,
  * and passing the parsed arguments.
  */
-void caseSave(char * token){
+void caseSave(Game *g, char * token){
 	int i;
 	char * n;
-	if (myGame.mode == Init) {
+	if (g->mode == Init) {
 		printf("ERROR: invalid command\n");
 		return;
 	}
@@ -329,7 +399,7 @@ void caseSave(char * token){
 		if (i<1) {
 			printf("ERROR: invalid command\n");
 			return;}
-		save(n);
+		save(g, n);
 		return;
 	}
 }
@@ -337,6 +407,7 @@ void caseSave(char * token){
 /* caseHint:
  * ---------
  * arguments:
+ * g - the game.
  * token - a string to be parsed.
  * description:
  * parses input farther, if the first few characters in the input,
@@ -346,9 +417,9 @@ void caseSave(char * token){
  * if the input specifies a valid command, calls the function handling the command,
  * and passing the parsed arguments.
  */
-void caseHint(char * token){
+void caseHint(Game *g, char * token){
 	int i, n1, n2, f1, f2;
-	if (myGame.mode != Solve){
+	if (g->mode != Solve){
 		printf("ERROR: invalid command\n");
 		return;}
 
@@ -362,27 +433,27 @@ void caseHint(char * token){
 				f1 = isNum(token);
 				if (f1) {
 					n1 = atoi(token);
-					f1 = ((n1>0) && (n1<=myGame.N));
+					f1 = ((n1>0) && (n1<=g->N));
 				}
 			}
 			if (i==2){
 				f2 = isNum(token);
 				if (f2) {
 					n2 = atoi(token);
-					f2 = ((n2>0) && (n2<=myGame.N));
+					f2 = ((n2>0) && (n2<=g->N));
 				}
 				break;
 			}
 		}
 	}
 	if (i == 2 && (!f1 || !f2)) { /*i indicates number of arguments, and f1-2 tell whether they are ints*/
-		printf("Error: value not in range 1-%d\n", myGame.N);
+		printf("Error: value not in range 1-%d\n", g->N);
 		return;}
 	if (i<2) {
 		printf("Error: invalid command\n");
 		return;}
 	else {
-		hint(--n1,--n2);
+		hint(g, --n1,--n2);
 		return;
 	}
 }
@@ -390,60 +461,119 @@ void caseHint(char * token){
 /* caseNumSolutions:
  * -----------------
  * arguments:
- * none.
+ * g - the game.
+ * token - a string to be parsed.
  * description:
  * parses input farther, if the first few characters in the input,
  * specify the case 'num_solutions'.
+ * an optional argument sets the number of counting threads
+ * (by default, all cores are used).
+ * if input is misformatted, or if the argument is not valid,
+ * prints an error message.
+ * if the input specifies a valid command, calls the function handling the command,
+ * and passing the parsed argument.
+ */
+void caseNumSolutions(Game *g, char * token){
+	int n = 0;
+	if (g->mode == Init) {
+		printf("ERROR: invalid command\n");
+		return;
+	}
+	token = strtok(NULL, " \r\t\n");
+	if (token != NULL) {
+		n = isNum(token) ? atoi(token) : 0;
+		if (n < 1 || n > MAX_THREADS) {
+			printf("Error: value not in range 1-%d\n", MAX_THREADS);
+			return;
+		}
+	}
+	numSolutions(g, n);
+}
+
+/* caseCheckUnique:
+ * ----------------
+ * arguments:
+ * g - the game.
+ * description:
+ * parses input farther, if the first few characters in the input,
+ * specify the case 'check_unique'.
  * if input is misformatted prints an error message.
  * if the input specifies a valid command, calls the function handling the command.
  */
-void caseNumSolutions(){
-	if (myGame.mode == Init) {
+void caseCheckUnique(Game *g){
+	if (g->mode == Init) {
 		printf("ERROR: invalid command\n");
 		return;
 	}
 	else{
-		numSolutions();
+		checkUnique(g);
 		return;}
 }
 
 /* caseAutofill:
  * -------------
  * arguments:
- * none.
+ * g - the game.
+ * token - a string to be parsed.
  * description:
  * parses input farther, if the first few characters in the input,
  * specify the case 'autofill'.
+ * an optional argument 'all' repeats the autofill until no cell is forced.
  * if input is misformatted prints an error message.
  * if the input specifies a valid command, calls the function handling the command.
  */
-void caseAutofill(){
-	if (myGame.mode != Solve) {
+void caseAutofill(Game *g, char * token){
+	if (g->mode != Solve) {
 		printf("ERROR: invalid command\n");
 		return;
 	}
-	else{
-		autofill();
+	token = strtok(NULL, " \r\t\n");
+	if (token == NULL) {
+		autofill(g);
+		return;}
+	if (strcmp(token, "all") == 0) {
+		autofillAll(g);
 		return;}
+	printf("ERROR: invalid command\n");
 }
 
 /* caseReset:
  * ----------
  * arguments:
- * none.
+ * g - the game.
  * description:
  * parses input farther, if the first few characters in the input,
  * specify the case 'reset'.
  * if input is misformatted prints an error message.
  * if the input specifies a valid command, calls the function handling the command.
  */
-void caseReset(){
-	if (myGame.mode == Init) {
+void caseReset(Game *g){
+	if (g->mode == Init) {
 		printf("ERROR: invalid command\n");
 		return;
 	}
 	else{
-		reset();
+		reset(g);
+		return;}
+}
+
+/* caseBoardHash:
+ * --------------
+ * arguments:
+ * g - the game.
+ * description:
+ * parses input farther, if the first few characters in the input,
+ * specify the (debug) case 'board_hash'.
+ * if input is misformatted prints an error message.
+ * if the input specifies a valid command, calls the function handling the command.
+ */
+void caseBoardHash(Game *g){
+	if (g->mode == Init) {
+		printf("ERROR: invalid command\n");
+		return;
+	}
+	else{
+		printHash(g);
 		return;}
 }
 
@@ -456,6 +586,7 @@ void caseReset(){
 /* parseGameLoop:
  * --------------
  * arguments:
+ * g - the game.
  * token - a string to be parsed.
  * description:
  * finds out whether input contains a valid command (and valid arguments).
@@ -465,7 +596,7 @@ void caseReset(){
  *     calls the method that handles the command that was inputted, along
  *     with the arguments, if there are any.
  */
-int parseGameLoop(char input[]){
+int parseGameLoop(Game *g, char input[]){
 	int inputHasNewLine = 0;
 	inputHasNewLine = hasNewLine(input);
 	if (!inputHasNewLine) {
@@ -478,67 +609,83 @@ int parseGameLoop(char input[]){
 			goto END;	}
 		/*CASE 1: SOLVE*/
 		if (token0[0] == 's' && token0[1] == 'o' && token0[2] == 'l' && token0[3] == 'v' && token0[4] == 'e' && (int)token0[5] == 0){
-			caseSolve(token0);
+			caseSolve(g, token0);
 			goto END;}
 		/*CASE 2: EDIT*/
 		if (token0[0] == 'e' && token0[1] == 'd' && token0[2] == 'i' && token0[3] == 't' && (int)token0[4] == 0){
-			caseEdit(token0);
+			caseEdit(g, token0);
 			goto END;}
 		/*CASE 3: MARK_ERRORS*/
 		if (token0[0] == 'm' && token0[1] == 'a' && token0[2] == 'r' && token0[3] == 'k' && token0[4] == '_' && token0[5] == 'e' && token0[6] == 'r' && token0[7] == 'r' && token0[8] == 'o' && token0[9] == 'r' && token0[10] == 's' && (int)token0[11] == 0){
-			caseMarkErrors(token0);
+			caseMarkErrors(g, token0);
 			goto END;}
 		/*CASE 4: PRINT_BOARD*/
 		if (token0[0] == 'p' && token0[1] == 'r' && token0[2] == 'i' && token0[3] == 'n'&& token0[4] == 't' && token0[5] == '_' && token0[6] == 'b' &&  token0[7] == 'o' && token0[8] == 'a' && token0[9] == 'r' && token0[10] == 'd' && (int)token0[11] == 0){
-			casePrintBoard();
+			casePrintBoard(g);
 			goto END;}
 		/*CASE 5: SET*/
 		if (token0[0] == 's' && token0[1] == 'e' && token0[2] == 't' && (int)token0[3] == 0){
-			caseSet(token0);
+			caseSet(g, token0);
 			goto END;}
 		/*CASE 6: VALIDATE*/
 		if (token0[0] == 'v' && token0[1] == 'a' && token0[2] == 'l' && token0[3] == 'i'&& token0[4] == 'd' && token0[5] == 'a' && token0[6] == 't' &&  token0[7] == 'e' && (int)token0[8] == 0){
-			validate();
+			validate(g);
 			goto END;}
 		/*CASE 7: GENERATE*/
 		if (token0[0] == 'g' && token0[1] == 'e' && token0[2] == 'n' && token0[3] == 'e'&& token0[4] == 'r' && token0[5] == 'a' && token0[6] == 't' &&  token0[7] == 'e' && (int)token0[8] == 0){
-			caseGenerate(token0);
+			caseGenerate(g, token0);
 			goto END;}
 		/*CASE 8: UNDO*/
 		if (token0[0] == 'u' && token0[1] == 'n' && token0[2] == 'd' && token0[3] == 'o' && (int)token0[4] == 0){
-			caseUndo();
+			caseUndo(g);
 			goto END;}
 		/*CASE 9: REDO*/
 		if (token0[0] == 'r' && token0[1] == 'e' && token0[2] == 'd' && token0[3] == 'o' && (int)token0[4] == 0){
-			caseRedo();
+			caseRedo(g);
 			goto END;}
 		/*CASE 10: SAVE*/
 		if (token0[0] == 's' && token0[1] == 'a' && token0[2] == 'v' && token0[3] == 'e' && (int)token0[4] == 0){
-			caseSave(token0);
+			caseSave(g, token0);
 			goto END;}
 		/*CASE 11: HINT*/
 		if (token0[0] == 'h' && token0[1] == 'i' && token0[2] == 'n' && token0[3] == 't' && (int)token0[4] == 0){
-			caseHint(token0);
+			caseHint(g, token0);
 			goto END;}
 		/*CASE 12: NUM_SOLUTIONS*/
 		if (token0[0] == 'n' && token0[1] == 'u' && token0[2] == 'm' && token0[3] == '_'&& token0[4] == 's' && token0[5] == 'o' && token0[6] == 'l' &&  token0[7] == 'u' && token0[8] == 't' && token0[9] == 'i' && token0[10] == 'o' && token0[11] == 'n' && token0[12] == 's' && (int)token0[13] == 0){
-			caseNumSolutions();
+			caseNumSolutions(g, token0);
 			goto END;}
 		/*CASE 13: AUTOFILL*/
 		if (token0[0] == 'a' && token0[1] == 'u' && token0[2] == 't' && token0[3] == 'o'&& token0[4] == 'f' && token0[5] == 'i' && token0[6] == 'l' &&  token0[7] == 'l' && (int)token0[8] == 0){
-			caseAutofill();
+			caseAutofill(g, token0);
 			goto END;}
 		/*CASE 14: RESET*/
 		if (token0[0] == 'r' && token0[1] == 'e' && token0[2] == 's' && token0[3] == 'e'&& token0[4] == 't' && (int)token0[5] == 0){
-			caseReset();
+			caseReset(g);
+			goto END;}
+		/*CASE 15: CHECK_UNIQUE*/
+		if (token0[0] == 'c' && token0[1] == 'h' && token0[2] == 'e' && token0[3] == 'c' && token0[4] == 'k' && token0[5] == '_' && token0[6] == 'u' && token0[7] == 'n' && token0[8] == 'i' && token0[9] == 'q' && token0[10] == 'u' && token0[11] == 'e' && (int)token0[12] == 0){
+			caseCheckUnique(g);
+			goto END;}
+		/*CASE 16: GENERATE_UNIQUE*/
+		if (token0[0] == 'g' && token0[1] == 'e' && token0[2] == 'n' && token0[3] == 'e' && token0[4] == 'r' && token0[5] == 'a' && token0[6] == 't' && token0[7] == 'e' && token0[8] == '_' && token0[9] == 'u' && token0[10] == 'n' && token0[11] == 'i' && token0[12] == 'q' && token0[13] == 'u' && token0[14] == 'e' && (int)token0[15] == 0){
+			caseGenerateUnique(g, token0);
+			goto END;}
+		/*CASE 17: BOARD_HASH*/
+		if (token0[0] == 'b' && token0[1] == 'o' && token0[2] == 'a' && token0[3] == 'r' && token0[4] == 'd' && token0[5] == '_' && token0[6] == 'h' && token0[7] == 'a' && token0[8] == 's' && token0[9] == 'h' && (int)token0[10] == 0){
+			caseBoardHash(g);
+			goto END;}
+		/*CASE 18: JUMP*/
+		if (token0[0] == 'j' && token0[1] == 'u' && token0[2] == 'm' && token0[3] == 'p' && (int)token0[4] == 0){
+			caseJump(g, token0);
 			goto END;}
-		/*CASE 15: EXIT*/
+		/*CASE 19: EXIT*/
 		if (token0[0] == 'e' && token0[1] == 'x' && token0[2] == 'i' && token0[3] == 't'&& (int)token0[4] == 0){
-			exitGame();}
+			exitGame(g);}
 		printf("ERROR: invalid command\n");}
 	END:
 	if (feof(stdin)) {
-		exitGame();}
+		exitGame(g);}
 	if (inputHasNewLine) {
 		return 1;}
 	do {
@@ -546,7 +693,7 @@ int parseGameLoop(char input[]){
 		inputHasNewLine = hasNewLine(input);
 	} while (!inputHasNewLine);
 	if (feof(stdin)) {
-		exitGame();}
+		exitGame(g);}
 	return 1;
 }
 
@@ -8,6 +8,6 @@
 #ifndef PARSER_H_
 #define PARSER_H_
 
-int parseGameLoop(char input[]);
+int parseGameLoop(Game *g, char input[]);
 
 #endif /* PARSER_H_ */
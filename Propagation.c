@@ -0,0 +1,264 @@
+/*
+ * Propagation.c
+ *
+ * this file implements the constraint-propagation engine, which fills and
+ * eliminates candidates of a SolverState by logical deduction alone, before
+ * any search is done. the rules are applied to a fixpoint, using a worklist
+ * of the units (rows, columns and blocks) that changed:
+ * - naked singles: a cell with a single candidate gets that value.
+ * - hidden singles: a value that fits only one cell of a unit goes there.
+ * - pointing: if a value's candidates in a block all lie in one row (or column),
+ *   it is eliminated from the rest of that row (column).
+ * - claiming: if a value's candidates in a row (or column) all lie in one block,
+ *   it is eliminated from the rest of that block.
+ * contents:
+ * 1. worklist auxiliary functions. (private)
+ * 2. rule functions. (private)
+ * 3. propagation function - propagate. (public)
+ *
+ */
+
+#include "DataStructures.h"
+#include "Solver.h"
+#include "Propagation.h"
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                          1. WORKLIST                            *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * bitToValue:
+ * -----------
+ * arguments:
+ * bit - a mask with a single value bit.
+ * description:
+ * returns the value represented by 'bit'.
+ */
+int bitToValue(unsigned int bit) {
+	int val = 1;
+	while (!(bit & 1u)) {
+		bit >>= 1;
+		val++;
+	}
+	return val;
+}
+
+/*
+ * pushUnit:
+ * ---------
+ * arguments:
+ * s - the state.
+ * u - a unit (see SolverState.units).
+ * tail - the position after the last unit in the worklist.
+ * description:
+ * adds unit u to the worklist (a cyclic queue of 3N units),
+ * unless it is already there.
+ * returns the new tail.
+ */
+int pushUnit(SolverState *s, int u, int tail) {
+	if (s->queued[u]) {
+		return tail;
+	}
+	s->queued[u] = 1;
+	s->unitQueue[tail] = u;
+	return (tail + 1)%(3*s->N);
+}
+
+/*
+ * pushUnitsOf:
+ * ------------
+ * arguments:
+ * s - the state.
+ * n - the number of a cell.
+ * tail - the position after the last unit in the worklist.
+ * description:
+ * adds the row, column and block of cell n to the worklist.
+ * returns the new tail.
+ */
+int pushUnitsOf(SolverState *s, int n, int tail) {
+	tail = pushUnit(s, s->cellRow[n], tail);
+	tail = pushUnit(s, s->N + s->cellCol[n], tail);
+	return pushUnit(s, 2*s->N + s->cellBlock[n], tail);
+}
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                            2. RULES                             *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * placeSingles:
+ * -------------
+ * arguments:
+ * s - the state.
+ * u - the unit to work on.
+ * tail - a pointer to the position after the last unit in the worklist.
+ * description:
+ * applies the naked-singles and hidden-singles rules to unit u,
+ * adding the units of every filled cell to the worklist.
+ * returns 0 if a contradiction was found (a cell without candidates,
+ * or a missing value that fits no cell), 1 otherwise.
+ */
+int placeSingles(SolverState *s, int u, int *tail) {
+	int i, n, last = 0, count, N = s->N, *cells = s->units + u*N;
+	unsigned int cands, bit;
+
+	/*naked singles*/
+	for (i = 0; i < N; i++) {
+		n = cells[i];
+		if (s->vals[n]) {
+			continue;
+		}
+		cands = candidatesOf(s, n);
+		if (!cands) {
+			return 0;
+		}
+		if (!(cands & (cands - 1))) {
+			setSolverValue(s, n, bitToValue(cands));
+			*tail = pushUnitsOf(s, n, *tail);
+		}
+	}
+
+	/*hidden singles*/
+	for (bit = 1u; bit < (1u << N); bit <<= 1) {
+		if (unitUsed(s, u) & bit) {
+			continue;
+		}
+		count = 0;
+		for (i = 0; i < N && count < 2; i++) {
+			n = cells[i];
+			if (!s->vals[n] && (candidatesOf(s, n) & bit)) {
+				last = n;
+				count++;
+			}
+		}
+		if (count == 0) {
+			return 0;
+		}
+		if (count == 1) {
+			setSolverValue(s, last, bitToValue(bit));
+			*tail = pushUnitsOf(s, last, *tail);
+		}
+	}
+	return 1;
+}
+
+/*
+ * eliminateOutside:
+ * -----------------
+ * arguments:
+ * s - the state.
+ * target - the unit to eliminate from.
+ * source - the unit whose cells are left alone.
+ * bit - the value to eliminate.
+ * tail - a pointer to the position after the last unit in the worklist.
+ * description:
+ * eliminates 'bit' from the cells of unit 'target' that are not in unit
+ * 'source', adding the units of every changed cell to the worklist.
+ */
+void eliminateOutside(SolverState *s, int target, int source, unsigned int bit, int *tail) {
+	int i, j, n, inSource, N = s->N, *cells = s->units + target*N;
+	for (i = 0; i < N; i++) {
+		n = cells[i];
+		if (s->vals[n] || !(candidatesOf(s, n) & bit)) {
+			continue;
+		}
+		inSource = 0;
+		for (j = 0; j < N && !inSource; j++) {
+			inSource = (s->units[source*N + j] == n);
+		}
+		if (!inSource) {
+			s->allowed[n] &= ~bit;
+			*tail = pushUnitsOf(s, n, *tail);
+		}
+	}
+}
+
+/*
+ * lockCandidates:
+ * ---------------
+ * arguments:
+ * s - the state.
+ * u - the unit to work on.
+ * tail - a pointer to the position after the last unit in the worklist.
+ * description:
+ * applies the pointing rule (if u is a block) or the claiming
+ * rule (if u is a row or a column) to unit u.
+ */
+void lockCandidates(SolverState *s, int u, int *tail) {
+	int i, n, row, col, block, N = s->N, *cells = s->units + u*N;
+	unsigned int bit;
+
+	for (bit = 1u; bit < (1u << N); bit <<= 1) {
+		if (unitUsed(s, u) & bit) {
+			continue;
+		}
+
+		/*find whether all the candidates of this value share a row, a column or a block*/
+		row = col = block = -1;
+		for (i = 0; i < N; i++) {
+			n = cells[i];
+			if (s->vals[n] || !(candidatesOf(s, n) & bit)) {
+				continue;
+			}
+			row = (row == -1 || row == s->cellRow[n]) ? s->cellRow[n] : -2;
+			col = (col == -1 || col == s->cellCol[n]) ? s->cellCol[n] : -2;
+			block = (block == -1 || block == s->cellBlock[n]) ? s->cellBlock[n] : -2;
+		}
+
+		if (u >= 2*N) { /*pointing*/
+			if (row >= 0) {
+				eliminateOutside(s, row, u, bit, tail);
+			}
+			if (col >= 0) {
+				eliminateOutside(s, N + col, u, bit, tail);
+			}
+		} else if (block >= 0) { /*claiming*/
+			eliminateOutside(s, 2*N + block, u, bit, tail);
+		}
+	}
+}
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                     3. PROPAGATION FUNCTION                     *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * propagate:
+ * ----------
+ * arguments:
+ * s - a state loaded with a board that has no erroneous values.
+ * description:
+ * fills and eliminates candidates of the board in 's' by applying naked
+ * singles, hidden singles, pointing and claiming until nothing changes.
+ * the deductions are kept in 's' (filled cells, and SolverState.allowed),
+ * so any search that follows only explores what is left.
+ * returns 0 if the board was found to be unsolvable, 1 otherwise.
+ */
+int propagate(SolverState *s) {
+	int u, head = 0, tail = 0, N = s->N;
+
+	for (u = 0; u < 3*N; u++) {
+		s->queued[u] = 0;
+	}
+	for (u = 0; u < 3*N; u++) {
+		tail = pushUnit(s, u, tail);
+	}
+
+	/*every unit is queued at most once, so the queue is empty exactly when the unit at its head is not queued*/
+	while (s->queued[s->unitQueue[head]]) {
+		u = s->unitQueue[head];
+		s->queued[u] = 0;
+		head = (head + 1)%(3*N);
+		if (!placeSingles(s, u, &tail)) {
+			return 0;
+		}
+		lockCandidates(s, u, &tail);
+	}
+	return 1;
+}
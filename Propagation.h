@@ -0,0 +1,14 @@
+/*
+ * Propagation.h
+ *
+ * this file allows other modules to use the constraint-propagation engine.
+ */
+
+#ifndef PROPAGATION_H_
+#define PROPAGATION_H_
+
+#include "DataStructures.h"
+
+int propagate(SolverState *s);
+
+#endif /* PROPAGATION_H_ */
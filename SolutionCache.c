@@ -0,0 +1,204 @@
+/*
+ * SolutionCache.c
+ *
+ * this file implements the solution cache, which keeps the last few solutions
+ * found for a game's board, so hint and validate don't have to solve the board
+ * again while the user only sets values that agree with one of them.
+ * for every cached solution, the cache counts the filled cells of the board that
+ * contradict it. the count is updated on every change of a cell's value (by
+ * updateCellStatus), so a solution is known to still solve the board, in O(1),
+ * iff its count is 0. a solution is never dropped because it was contradicted,
+ * since an undo can make it agree with the board again; when the cache is full,
+ * the least recently used solution is replaced.
+ * contents:
+ * 1. cache functions - clearSolutionCache, updateSolutionCache,
+ *    recountSolutionCache, loadCachedSolution, cacheSolution, solveAndCache. (public)
+ *
+ */
+
+#include <stdlib.h>
+#include "DataStructures.h"
+#include "AuxMethods.h"
+#include "Validate.h"
+#include "SolutionCache.h"
+
+#define CACHE_SIZE 4 /*number of solutions kept*/
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                            1. CACHE                             *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * clearSolutionCache:
+ * -------------------
+ * arguments:
+ * g - the game.
+ * description:
+ * drops all the cached solutions, and frees the cache's memory.
+ * to be called whenever a new board is created, and on exit.
+ */
+void clearSolutionCache(Game *g) {
+	free(g->cache.solutions);
+	free(g->cache.conflicts);
+	free(g->cache.lastUsed);
+	g->cache.size = 0;
+	g->cache.numSolutions = 0;
+	g->cache.clock = 0;
+	g->cache.solutions = NULL;
+	g->cache.conflicts = NULL;
+	g->cache.lastUsed = NULL;
+}
+
+/*
+ * updateSolutionCache:
+ * --------------------
+ * arguments:
+ * g - the game.
+ * n - the number (left to right, then top to bottom) of the changed cell.
+ * val - new value of the cell.
+ * old - old value of the cell.
+ * description:
+ * to be called after the n'th cell's value was changed from 'old' to 'val'.
+ * updates the number of cells that contradict every cached solution.
+ */
+void updateSolutionCache(Game *g, int n, int val, int old) {
+	int i, sol;
+	for (i = 0; i < g->cache.numSolutions; i++) {
+		sol = g->cache.solutions[i*g->cache.size + n];
+		if (old && old != sol) {
+			g->cache.conflicts[i]--;
+		}
+		if (val && val != sol) {
+			g->cache.conflicts[i]++;
+		}
+	}
+}
+
+/*
+ * recountSolutionCache:
+ * ---------------------
+ * arguments:
+ * g - the game.
+ * description:
+ * counts again, for every cached solution, the filled cells of the board
+ * that contradict it. to be called when the whole board was replaced
+ * (see recountBoard), instead of updateSolutionCache for every cell.
+ */
+void recountSolutionCache(Game *g) {
+	int i, n, val;
+	for (i = 0; i < g->cache.numSolutions; i++) {
+		g->cache.conflicts[i] = 0;
+		for (n = 0; n < g->cache.size; n++) {
+			val = getVal(g, n);
+			if (val && val != g->cache.solutions[i*g->cache.size + n]) {
+				g->cache.conflicts[i]++;
+			}
+		}
+	}
+}
+
+/*
+ * loadCachedSolution:
+ * -------------------
+ * arguments:
+ * g - the game.
+ * description:
+ * if a cached solution agrees with every filled cell of the board, stores
+ * the most recently used one in the demiVal field of the cells, without
+ * solving the board.
+ * returns 1 iff a solution was stored.
+ */
+int loadCachedSolution(Game *g) {
+	int i, n, best = -1;
+	int *sol;
+
+	for (i = 0; i < g->cache.numSolutions; i++) {
+		if (g->cache.conflicts[i] == 0 &&
+				(best < 0 || g->cache.lastUsed[i] > g->cache.lastUsed[best])) {
+			best = i;
+		}
+	}
+	if (best < 0) {
+		return 0;
+	}
+
+	sol = g->cache.solutions + best*g->cache.size;
+	for (n = 0; n < g->cache.size; n++) {
+		setDemiVal(g, n, sol[n]);
+	}
+	g->cache.lastUsed[best] = ++g->cache.clock;
+	return 1;
+}
+
+/*
+ * cacheSolution:
+ * --------------
+ * arguments:
+ * g - the game.
+ * description:
+ * adds the solution stored in the demiVal field of the cells (by ILPvalidate)
+ * to the cache, replacing the least recently used solution if the cache is full.
+ * the cache only saves solving again, so if there is not enough memory for
+ * it, nothing is cached.
+ */
+void cacheSolution(Game *g) {
+	int i, n, slot, size = g->N*g->N;
+	int *sol;
+
+	/*the first solution of a board allocates the cache
+	  (clearSolutionCache frees it whenever a new board is started)*/
+	if (g->cache.solutions == NULL) {
+		g->cache.solutions = malloc(CACHE_SIZE*size*sizeof(int));
+		g->cache.conflicts = malloc(CACHE_SIZE*sizeof(int));
+		g->cache.lastUsed = malloc(CACHE_SIZE*sizeof(int));
+		if (!g->cache.solutions || !g->cache.conflicts || !g->cache.lastUsed) {
+			clearSolutionCache(g);
+			return;
+		}
+		g->cache.size = size;
+	}
+
+	if (g->cache.numSolutions < CACHE_SIZE) {
+		slot = g->cache.numSolutions++;
+	} else {
+		slot = 0;
+		for (i = 1; i < CACHE_SIZE; i++) {
+			if (g->cache.lastUsed[i] < g->cache.lastUsed[slot]) {
+				slot = i;
+			}
+		}
+	}
+
+	/*the solution extends the board, so no cell contradicts it*/
+	sol = g->cache.solutions + slot*size;
+	for (n = 0; n < size; n++) {
+		sol[n] = getDemiVal(g, n) ? getDemiVal(g, n) : getVal(g, n);
+	}
+	g->cache.conflicts[slot] = 0;
+	g->cache.lastUsed[slot] = ++g->cache.clock;
+}
+
+/*
+ * solveAndCache:
+ * --------------
+ * arguments:
+ * g - the game.
+ * description:
+ * solves the board using ILP (by calling ILPvalidate). if a solution
+ * was found, it is left in the cells' demiVal field, and cached.
+ * returns 1 if a solution was found, 0 if there is none (or no board was
+ * started), and -1 if there is not enough memory to solve the board.
+ */
+int solveAndCache(Game *g) {
+	int result;
+	if (g->N == 0) {
+		return 0;
+	}
+	clearDemiVals(g, 0);
+	result = ILPvalidate(g);
+	if (result == 1) {
+		cacheSolution(g);
+	}
+	return result;
+}
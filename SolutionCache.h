@@ -0,0 +1,17 @@
+/*
+ * SolutionCache.h
+ *
+ * this file allows other modules to use the solution cache.
+ */
+
+#ifndef SOLUTIONCACHE_H_
+#define SOLUTIONCACHE_H_
+
+void clearSolutionCache(Game *g);
+void updateSolutionCache(Game *g, int n, int val, int old);
+void recountSolutionCache(Game *g);
+int loadCachedSolution(Game *g);
+void cacheSolution(Game *g);
+int solveAndCache(Game *g);
+
+#endif /* SOLUTIONCACHE_H_ */
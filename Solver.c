@@ -0,0 +1,598 @@
+/*
+ * Solver.c
+ *
+ * this file implements the bitmask search engine, which is used to count
+ * the solutions of a board, or to check whether it has a unique solution.
+ * the engine works on a SolverState - a copy of the board that keeps the used
+ * values of every row, column and block as bitmasks, so the candidates of a cell
+ * are found with a single OR. the search always branches on the empty cell
+ * with the fewest candidates, and keeps its stack in arrays that are
+ * allocated once, when the state is created.
+ * contents:
+ * 1. solver-state functions. (public)
+ * 2. search auxiliary functions. (private)
+ * 3. counting functions - searchSolutions (private), countSolutionsUpTo, countSolutions,
+ *    classifySolutions, findSolution, findRandomSolution, removeClues. (public)
+ *
+ */
+
+#include <stdlib.h>
+#include "DataStructures.h"
+#include "AuxMethods.h"
+#include "Solver.h"
+#include "Propagation.h"
+
+#define QUICK_NODES 4L /*values per cell a uniqueness check of removeClues places before propagating*/
+#define REMOVE_NODES 64L /*values per cell a uniqueness check of removeClues may place*/
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                        1. SOLVER STATE                          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * createSolver:
+ * -------------
+ * arguments:
+ * s - the state to initialize.
+ * blockW - block width.
+ * blockH - block height.
+ * description:
+ * allocates an empty board of the requested dimensions in 's'.
+ * returns 1 on success, and 0 if there is not enough memory (then
+ * nothing is left allocated, and freeSolver may still be called).
+ */
+int createSolver(SolverState *s, int blockW, int blockH) {
+	int n, N = blockW*blockH;
+	s->blockW = blockW;
+	s->blockH = blockH;
+	s->N = N;
+	s->vals = malloc((8*N*N + 6*N)*sizeof(int));
+	s->rowMask = malloc((3*N + 3*N*N)*sizeof(unsigned int));
+	if (s->vals == NULL || s->rowMask == NULL) {
+		freeSolver(s);
+		s->vals = NULL;
+		s->rowMask = NULL;
+		return 0;
+	}
+	s->cellRow = s->vals + N*N;
+	s->cellCol = s->cellRow + N*N;
+	s->cellBlock = s->cellCol + N*N;
+	s->empty = s->cellBlock + N*N;
+	s->units = s->empty + N*N;
+	s->unitQueue = s->units + 3*N*N;
+	s->queued = s->unitQueue + 3*N;
+	s->colMask = s->rowMask + N;
+	s->blockMask = s->colMask + N;
+	s->allowed = s->blockMask + N;
+	s->untried = s->allowed + N*N;
+	s->placed = s->untried + N*N;
+	for (n = 0; n < N*N; n++) {
+		s->cellRow[n] = n/N;
+		s->cellCol[n] = n%N;
+		s->cellBlock[n] = (s->cellRow[n]/blockH)*blockH + s->cellCol[n]/blockW;
+	}
+
+	/*list the cells of every unit*/
+	for (n = 0; n < N*N; n++) {
+		s->units[s->cellRow[n]*N + s->cellCol[n]] = n;
+		s->units[(N + s->cellCol[n])*N + s->cellRow[n]] = n;
+		s->units[(2*N + s->cellBlock[n])*N + (s->cellRow[n]%blockH)*blockW + s->cellCol[n]%blockW] = n;
+	}
+	clearSolver(s);
+	return 1;
+}
+
+/*
+ * freeSolver:
+ * -----------
+ * arguments:
+ * s - the state to free.
+ * description:
+ * frees the memory of 's'.
+ */
+void freeSolver(SolverState *s) {
+	free(s->vals);
+	free(s->rowMask);
+}
+
+/*
+ * clearSolver:
+ * ------------
+ * arguments:
+ * s - the state to clear.
+ * description:
+ * empties every cell of the board in 's'.
+ */
+void clearSolver(SolverState *s) {
+	int n, N = s->N;
+	for (n = 0; n < N; n++) {
+		s->rowMask[n] = 0;
+		s->colMask[n] = 0;
+		s->blockMask[n] = 0;
+	}
+	for (n = 0; n < N*N; n++) {
+		s->vals[n] = 0;
+		s->empty[n] = n;
+		s->allowed[n] = (1u << N) - 1;
+	}
+	s->numEmpty = N*N;
+}
+
+/*
+ * setSolverValue:
+ * ---------------
+ * arguments:
+ * s - the state.
+ * n - the number of an empty cell (counting left to right, then top to bottom).
+ * val - the value to place (1 to N).
+ * description:
+ * places 'val' in cell n, and removes the cell from the empty cells.
+ * returns 0 if 'val' is already used in the cell's row, column or block
+ * (and leaves the state unchanged), 1 otherwise.
+ */
+int setSolverValue(SolverState *s, int n, int val) {
+	int i;
+	unsigned int bit = 1u << (val - 1);
+	if (!(candidatesOf(s, n) & bit)) {
+		return 0;
+	}
+	placeBit(s, n, bit);
+	i = 0;
+	while (s->empty[i] != n) {
+		i++;
+	}
+	s->empty[i] = s->empty[--s->numEmpty];
+	return 1;
+}
+
+/*
+ * unsetSolverValue:
+ * -----------------
+ * arguments:
+ * s - the state.
+ * n - the number of a filled cell.
+ * description:
+ * empties cell n, and returns it to the empty cells.
+ */
+void unsetSolverValue(SolverState *s, int n) {
+	removeBit(s, n, 1u << (s->vals[n] - 1));
+	s->empty[s->numEmpty++] = n;
+}
+
+/*
+ * copySolver:
+ * -----------
+ * arguments:
+ * dst - a state created with the dimensions of 'src'.
+ * src - the state to copy.
+ * description:
+ * copies the board in 'src', and the values eliminated from its cells, into 'dst'.
+ */
+void copySolver(SolverState *dst, SolverState *src) {
+	int n, N = src->N;
+	clearSolver(dst);
+	for (n = 0; n < N*N; n++) {
+		if (src->vals[n]) {
+			setSolverValue(dst, n, src->vals[n]);
+		}
+	}
+	for (n = 0; n < N*N; n++) {
+		dst->allowed[n] = src->allowed[n];
+	}
+}
+
+/*
+ * storeSolverValues:
+ * ------------------
+ * arguments:
+ * g - the game.
+ * s - a state with the dimensions of g.
+ * description:
+ * stores the value of every filled cell in 's' in the
+ * demiVal field of the corresponding cell of g.
+ */
+void storeSolverValues(Game *g, SolverState *s) {
+	int n, N = s->N;
+	for (n = 0; n < N*N; n++) {
+		if (s->vals[n]) {
+			setDemiVal(g, n, s->vals[n]);
+		}
+	}
+}
+
+/*
+ * loadSolverFromGame:
+ * -------------------
+ * arguments:
+ * g - the game.
+ * s - a state created with the dimensions of g.
+ * description:
+ * copies the values of the board of g into 's'.
+ * returns 0 if the board contains erroneous values, 1 otherwise.
+ */
+int loadSolverFromGame(Game *g, SolverState *s) {
+	int n, val, N = s->N;
+	clearSolver(s);
+	for (n = 0; n < N*N; n++) {
+		val = getVal(g, n);
+		if (val && !setSolverValue(s, n, val)) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                    2. SEARCH AUXILIARY FUNCTIONS                *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * candidatesOf:
+ * -------------
+ * arguments:
+ * s - the state.
+ * n - the number of an empty cell.
+ * description:
+ * returns a mask of the values that are legal for cell n,
+ * and were not eliminated from it by propagation.
+ */
+unsigned int candidatesOf(SolverState *s, int n) {
+	unsigned int used = s->rowMask[s->cellRow[n]] | s->colMask[s->cellCol[n]] | s->blockMask[s->cellBlock[n]];
+	return ~used & s->allowed[n];
+}
+
+/*
+ * unitUsed:
+ * ---------
+ * arguments:
+ * s - the state.
+ * u - a unit (see SolverState.units).
+ * description:
+ * returns the mask of the values used in unit u.
+ */
+unsigned int unitUsed(SolverState *s, int u) {
+	if (u < s->N) {
+		return s->rowMask[u];
+	}
+	if (u < 2*s->N) {
+		return s->colMask[u - s->N];
+	}
+	return s->blockMask[u - 2*s->N];
+}
+
+/*
+ * placeBit:
+ * ---------
+ * arguments:
+ * s - the state.
+ * n - the number of a cell.
+ * bit - the bit of the value to place in cell n.
+ * description:
+ * places the value represented by 'bit' in cell n, updating the masks.
+ */
+void placeBit(SolverState *s, int n, unsigned int bit) {
+	int val = 1;
+	s->rowMask[s->cellRow[n]] |= bit;
+	s->colMask[s->cellCol[n]] |= bit;
+	s->blockMask[s->cellBlock[n]] |= bit;
+	while (!(bit & 1u)) {
+		bit >>= 1;
+		val++;
+	}
+	s->vals[n] = val;
+}
+
+/*
+ * removeBit:
+ * ----------
+ * arguments:
+ * s - the state.
+ * n - the number of a cell.
+ * bit - the bit of the value currently in cell n.
+ * description:
+ * empties cell n, updating the masks.
+ */
+void removeBit(SolverState *s, int n, unsigned int bit) {
+	s->rowMask[s->cellRow[n]] &= ~bit;
+	s->colMask[s->cellCol[n]] &= ~bit;
+	s->blockMask[s->cellBlock[n]] &= ~bit;
+	s->vals[n] = 0;
+}
+
+/*
+ * chooseCell:
+ * -----------
+ * arguments:
+ * s - the state.
+ * depth - the current search depth.
+ * description:
+ * finds the unfilled cell (empty[depth] onwards) with the fewest
+ * candidates, and swaps it into empty[depth].
+ * returns its candidates mask (0 means the branch is a dead end).
+ */
+unsigned int chooseCell(SolverState *s, int depth) {
+	int i, count, best = depth, bestCount = s->N + 1, tmp;
+	unsigned int cands, bestCands = 0;
+	for (i = depth; i < s->numEmpty; i++) {
+		cands = candidatesOf(s, s->empty[i]);
+		count = 0;
+		while (cands && count < bestCount) {
+			cands &= cands - 1;
+			count++;
+		}
+		if (count < bestCount) {
+			best = i;
+			bestCount = count;
+			bestCands = candidatesOf(s, s->empty[i]);
+			if (count <= 1) {
+				break;
+			}
+		}
+	}
+	tmp = s->empty[depth];
+	s->empty[depth] = s->empty[best];
+	s->empty[best] = tmp;
+	return bestCands;
+}
+
+
+/*
+ * randomBit:
+ * ----------
+ * arguments:
+ * rng - a random state (see nextRandom).
+ * mask - a non-zero mask.
+ * description:
+ * returns one of the set bits of 'mask', chosen uniformly at random.
+ */
+unsigned int randomBit(unsigned long *rng, unsigned int mask) {
+	int count = 0, r;
+	unsigned int rest;
+	for (rest = mask; rest; rest &= rest - 1) {
+		count++;
+	}
+	for (r = randInt(rng, count); r > 0; r--) {
+		mask &= mask - 1;
+	}
+	return mask & (~mask + 1);
+}
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                      3. COUNTING FUNCTION                       *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * searchSolutions:
+ * ----------------
+ * arguments:
+ * s - a state loaded with a board that has no erroneous values.
+ * limit - the search stops once this many solutions were found (0 for no limit).
+ * keep - if set, the board of the last solution found is left in 's'.
+ * rng - if not NULL, the candidates of every cell are tried in random order
+ *       (drawn from this random state), otherwise from the smallest value up.
+ * maxNodes - the search gives up after placing this many values (0 for no limit).
+ * description:
+ * returns the number of solutions of the board in 's' (but at most 'limit'),
+ * using a depth-first search that branches on the cell with the fewest candidates,
+ * or -1 if the search gave up.
+ * unless 'keep' is set and a solution was found, the board in 's' is left as it was.
+ */
+long searchSolutions(SolverState *s, long limit, int keep, unsigned long *rng, long maxNodes) {
+	long counter = 0, nodes = 0;
+	int depth = 0, n;
+	unsigned int bit;
+
+	if (s->numEmpty == 0) {
+		return 1;
+	}
+	s->untried[0] = chooseCell(s, 0);
+	s->placed[0] = 0;
+	while (depth >= 0) {
+		n = s->empty[depth];
+
+		/*if enough solutions were found, and the last one should be kept, stop here*/
+		if (keep && limit && counter >= limit) {
+			break;
+		}
+
+		/*take back the value placed in this depth's cell*/
+		if (s->placed[depth]) {
+			removeBit(s, n, s->placed[depth]);
+			s->placed[depth] = 0;
+		}
+
+		/*if all the candidates were tried, or enough solutions were found, backtrack*/
+		if (!s->untried[depth] || (limit && counter >= limit)) {
+			depth--;
+			continue;
+		}
+
+		/*if the search is too long, take back all the values and give up*/
+		if (maxNodes && ++nodes > maxNodes) {
+			for (; depth >= 0; depth--) {
+				if (s->placed[depth]) {
+					removeBit(s, s->empty[depth], s->placed[depth]);
+				}
+			}
+			return -1;
+		}
+
+		/*place the next candidate*/
+		bit = rng ? randomBit(rng, s->untried[depth]) : s->untried[depth] & (~s->untried[depth] + 1);
+		s->untried[depth] &= ~bit;
+		placeBit(s, n, bit);
+		s->placed[depth] = bit;
+
+		if (depth + 1 == s->numEmpty) { /*board is filled with a valid solution*/
+			counter++;
+			continue;
+		}
+		depth++;
+		s->untried[depth] = chooseCell(s, depth);
+		s->placed[depth] = 0;
+	}
+	return counter;
+}
+
+/*
+ * countSolutionsUpTo:
+ * -------------------
+ * arguments:
+ * s - a state loaded with a board that has no erroneous values.
+ * limit - the search stops once this many solutions were found (0 for no limit).
+ * description:
+ * returns the number of solutions of the board in 's' (but at most 'limit').
+ * the board in 's' is left as it was.
+ */
+long countSolutionsUpTo(SolverState *s, long limit) {
+	return searchSolutions(s, limit, 0, NULL, 0);
+}
+
+/*
+ * countSolutions:
+ * ---------------
+ * arguments:
+ * s - a state loaded with a board that has no erroneous values.
+ * description:
+ * returns the number of solutions of the board in 's', using an exhaustive search.
+ * the board in 's' is left as it was.
+ */
+long countSolutions(SolverState *s) {
+	return countSolutionsUpTo(s, 0);
+}
+
+/*
+ * classifySolutions:
+ * ------------------
+ * arguments:
+ * s - a state loaded with a board that has no erroneous values.
+ * description:
+ * returns 0 if the board in 's' has no solution, 1 if it has exactly one,
+ * and 2 if it has more than one. the search stops as soon as a
+ * second solution is found.
+ * the board in 's' is left as it was.
+ */
+int classifySolutions(SolverState *s) {
+	return (int)countSolutionsUpTo(s, 2);
+}
+
+/*
+ * findSolution:
+ * -------------
+ * arguments:
+ * s - a state loaded with a board that has no erroneous values.
+ * description:
+ * searches for a single solution of the board in 's'. if one is found,
+ * every cell of s->vals is left filled with it (the empty-cells list
+ * is not changed, so the state should be cleared before reuse).
+ * returns 1 iff a solution was found.
+ */
+int findSolution(SolverState *s) {
+	return searchSolutions(s, 1, 1, NULL, 0) == 1;
+}
+
+/*
+ * findRandomSolution:
+ * -------------------
+ * arguments:
+ * s - a state loaded with a board that has no erroneous values.
+ * rng - a random state (see nextRandom).
+ * description:
+ * same as findSolution, but the candidates of every cell are tried in
+ * random order, so every call on an empty board finds a random full grid.
+ * a random search can get stuck in a large subtree without solutions, so
+ * it is restarted with a new random order whenever it runs too long, and
+ * the allowed length is doubled on every restart.
+ * returns 1 iff a solution was found.
+ */
+int findRandomSolution(SolverState *s, unsigned long *rng) {
+	long result, maxNodes = 4*s->N*s->N;
+	do {
+		result = searchSolutions(s, 1, 1, rng, maxNodes);
+		maxNodes *= 2;
+	} while (result < 0);
+	return result == 1;
+}
+
+/*
+ * removeClues:
+ * ------------
+ * arguments:
+ * s - a state holding a board with a unique solution (e.g. a full grid).
+ * order - the cells to try to remove, in order (a permutation of all the cells).
+ * target - the number of clues to stop at (0 to go on until the puzzle is minimal).
+ * minimal - set to 0 if a search was given up, 1 otherwise.
+ * description:
+ * removes the clues of the board in 's' one by one, in the given order, keeping
+ * only the removals after which the solution is still unique. a removal of
+ * value v from cell n keeps the solution unique iff the board has no solution
+ * with a different value in cell n.
+ * such a solution is first searched for in a scratch state, which holds the
+ * same board as 's' and is created once: every trial empties cell n in both
+ * states (updating the masks of its row, column and block), eliminates v from
+ * it in the scratch state, and a clue that has to stay is placed back in both.
+ * only a search that takes more than QUICK_NODES values per cell is repeated
+ * on a propagated copy of the scratch state, and if that search takes more
+ * than REMOVE_NODES values per cell, it is given up and the clue is kept, so
+ * the solution always stays unique, but the clue might have been removable.
+ * searches are only given up on large boards (16x16 and up), where running
+ * them to completion takes seconds per removal.
+ * since removing clues never removes solutions, a clue that couldn't be
+ * removed once can't be removed later, so when no target is reached and
+ * 'minimal' is set, the result is minimal.
+ * returns the number of clues left in 's', or -1 if there is not enough
+ * memory for the scratch states (then 's' is left as it was).
+ */
+int removeClues(SolverState *s, int *order, int target, int *minimal) {
+	int i, n, val, clues = s->N*s->N - s->numEmpty;
+	long found;
+	unsigned int bit;
+	SolverState scratch, deduced;
+
+	if (!createSolver(&scratch, s->blockW, s->blockH)) {
+		return -1;
+	}
+	if (!createSolver(&deduced, s->blockW, s->blockH)) {
+		freeSolver(&scratch);
+		return -1;
+	}
+	copySolver(&scratch, s);
+	*minimal = 1;
+	for (i = 0; i < s->N*s->N && clues > target; i++) {
+		n = order[i];
+		val = s->vals[n];
+		if (!val) {
+			continue;
+		}
+		bit = 1u << (val - 1);
+		unsetSolverValue(s, n);
+		unsetSolverValue(&scratch, n);
+
+		/*look for a solution that doesn't use the removed clue, propagating only if it is hard to find*/
+		scratch.allowed[n] &= ~bit;
+		found = searchSolutions(&scratch, 1, 0, NULL, QUICK_NODES*s->N*s->N);
+		if (found < 0) {
+			copySolver(&deduced, &scratch);
+			found = propagate(&deduced) ? searchSolutions(&deduced, 1, 0, NULL, REMOVE_NODES*s->N*s->N) : 0;
+		}
+		scratch.allowed[n] |= bit;
+		if (found < 0) {
+			*minimal = 0;
+		}
+		if (found != 0) {
+			setSolverValue(s, n, val);
+			setSolverValue(&scratch, n, val);
+			continue;
+		}
+		clues--;
+	}
+	freeSolver(&scratch);
+	freeSolver(&deduced);
+	return clues;
+}
@@ -0,0 +1,33 @@
+/*
+ * Solver.h
+ *
+ * this file allows other modules to use the bitmask search engine.
+ */
+
+#ifndef SOLVER_H_
+#define SOLVER_H_
+
+#include "DataStructures.h"
+
+int createSolver(SolverState *s, int blockW, int blockH);
+void freeSolver(SolverState *s);
+void clearSolver(SolverState *s);
+int setSolverValue(SolverState *s, int n, int val);
+void unsetSolverValue(SolverState *s, int n);
+void copySolver(SolverState *dst, SolverState *src);
+void storeSolverValues(Game *g, SolverState *s);
+int loadSolverFromGame(Game *g, SolverState *s);
+unsigned int candidatesOf(SolverState *s, int n);
+unsigned int unitUsed(SolverState *s, int u);
+void placeBit(SolverState *s, int n, unsigned int bit);
+void removeBit(SolverState *s, int n, unsigned int bit);
+unsigned int chooseCell(SolverState *s, int depth);
+unsigned int randomBit(unsigned long *rng, unsigned int mask);
+long countSolutionsUpTo(SolverState *s, long limit);
+long countSolutions(SolverState *s);
+int classifySolutions(SolverState *s);
+int findSolution(SolverState *s);
+int findRandomSolution(SolverState *s, unsigned long *rng);
+int removeClues(SolverState *s, int *order, int target, int *minimal);
+
+#endif /* SOLVER_H_ */
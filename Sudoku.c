@@ -0,0 +1,563 @@
+/*
+ * Sudoku.c
+ *
+ * this file implements the sudoku engine: the operations on a game (loading,
+ * saving, setting, solving, counting, hinting, generating, and going through
+ * the moves), without any
+ * output. every function gets the game it works on, returns a result code
+ * (see SudokuResult in Sudoku.h), and passes any other result through its
+ * pointer arguments. columns and rows are counted from 0.
+ * the console (Game.c) reports these results to the user, and other programs
+ * use them through libsudoku (see the makefile).
+ * a game must be prepared with initGame before its first use, and released
+ * with freeGame. until a board is started (by sudokuNew or sudokuLoad), the
+ * other functions return SudokuNoBoard.
+ * the engine allocates with malloc, and any function may return
+ * SudokuOutOfMemory when it fails; the game is then left as it was (except
+ * that sudokuNew and sudokuLoad leave it with no board).
+ * contents:
+ * 1. board functions - sudokuNew, sudokuLoad, sudokuSave, sudokuSet. (public)
+ * 2. solution functions - sudokuSolve, sudokuHint, sudokuCount, sudokuCheckUnique. (public)
+ * 3. generate functions - sudokuGenerate, sudokuGenerateUnique. (public)
+ * 4. moves functions - sudokuUndo, sudokuRedo, sudokuJump, sudokuReset, sudokuAutofill. (public)
+ *
+ */
+
+#include <stdio.h>
+#include "DataStructures.h"
+#include "AuxMethods.h"
+#include "Solver.h"
+#include "Propagation.h"
+#include "ParallelCount.h"
+#include "SolutionCache.h"
+#include "GridPool.h"
+#include "Sudoku.h"
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                            1. BOARD                             *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * sudokuNew:
+ * ----------
+ * arguments:
+ * g - the game.
+ * blockW - block width.
+ * blockH - block height.
+ * m - game mode.
+ * description:
+ * starts a new game on an empty board with blocks of blockH x blockW.
+ * returns SudokuOutOfRange if the board would not have 1 to MAX_N values
+ * in a row, SudokuOutOfMemory, or SudokuOk otherwise.
+ */
+int sudokuNew(Game *g, int blockW, int blockH, enum Mode m) {
+	if (blockW < 1 || blockH < 1 || blockW*blockH > MAX_N) {
+		return SudokuOutOfRange;
+	}
+	if (!createGame(g, blockW, blockH, m)) {
+		return SudokuOutOfMemory;
+	}
+	return SudokuOk;
+}
+
+/*
+ * sudokuLoad:
+ * -----------
+ * arguments:
+ * g - the game.
+ * path - the address of the file to load from.
+ * m - game mode. in EDIT mode, no cell is loaded as fixed.
+ * description:
+ * starts a new game on the board saved in 'path'.
+ * returns SudokuFileError if the file cannot be opened, or ends before
+ * the whole board was read (the game is left as it was), SudokuOutOfMemory,
+ * or SudokuOk otherwise.
+ */
+int sudokuLoad(Game *g, const char *path, enum Mode m) {
+	FILE *ifp = fopen(path, "r");
+	int blockH, blockW, N, n, ok, val, fixed;
+	unsigned char vals[MAX_N*MAX_N], fixedCells[MAX_N*MAX_N];
+
+	if (ifp == NULL) {
+		return SudokuFileError;
+	}
+
+	/*read the whole board before the game is changed*/
+	blockH = readSize(ifp);
+	blockW = readSize(ifp);
+	N = blockH*blockW;
+	ok = (N != 0);
+	for (n = 0; ok && n < N*N; n++) {
+		ok = readNextCell(ifp, N, &val, &fixed);
+		vals[n] = (unsigned char)val;
+		fixedCells[n] = (unsigned char)(fixed && m != Edit);
+	}
+	fclose(ifp);
+	if (!ok) {
+		return SudokuFileError;
+	}
+
+	/*create board, and fill cells*/
+	if (!createGame(g, blockW, blockH, m)) {
+		return SudokuOutOfMemory;
+	}
+	for (n = 0; n < N*N; n++) {
+		setVal(g, n, vals[n]);
+		setFixedCell(g, n, fixedCells[n]);
+		if (vals[n]) {
+			g->numFilled++;
+		}
+		updateCellStatus(g, getCol(g, n), getRow(g, n), vals[n], 0);
+	}
+	takeSnapshot(g);
+	return SudokuOk;
+}
+
+/*
+ * sudokuSave:
+ * -----------
+ * arguments:
+ * g - the game.
+ * path - the address of the file to save into.
+ * uniqueness - if not NULL, set to 2 if the board (in EDIT mode) has more
+ * than one solution, and to 1 otherwise.
+ * description:
+ * saves the board into 'path'. in EDIT mode, all filled cells are saved
+ * as fixed, and the board must not be erroneous and must be solvable.
+ * returns SudokuErroneous, SudokuUnsolvable, SudokuOutOfMemory or
+ * SudokuFileError if the board cannot be saved, SudokuOk otherwise.
+ */
+int sudokuSave(Game *g, const char *path, int *uniqueness) {
+	FILE *ifp;
+	int row, col, n, ok, result = 1;
+
+	if (g->N == 0) {
+		return SudokuNoBoard;
+	}
+	/*check preconditions for EDIT mode*/
+	if (g->mode == Edit) {
+		if (isErroneous(g)) {
+			return SudokuErroneous;
+		}
+		result = boardUniqueness(g);
+		if (result < 0) {
+			return SudokuOutOfMemory;
+		}
+		if (!result) {
+			return SudokuUnsolvable;
+		}
+	}
+	if (uniqueness) {
+		*uniqueness = result;
+	}
+
+	/*save game. in EDIT mode, writeCell saves every filled cell as fixed*/
+	ifp = fopen(path, "w");
+	if (ifp == NULL) {
+		return SudokuFileError;
+	}
+	ok = writeSize(ifp, g->blockH, g->blockW);
+	for (row = 0; ok && row < g->N; row++) {
+		for (col = 0; ok && col < g->N - 1; col++) {
+			n = getN(g, col, row);
+			ok = writeCell(g, ifp, n, getVal(g, n));
+		}
+		n = getN(g, col, row);
+		ok = ok && writeCellEndOfLine(g, ifp, n, getVal(g, n)) && fputc('\n', ifp) != EOF;
+	}
+	if (fclose(ifp) == EOF || !ok) {
+		return SudokuFileError;
+	}
+	return SudokuOk;
+}
+
+/*
+ * sudokuSet:
+ * ----------
+ * arguments:
+ * g - the game.
+ * col - cell's column (0 to N-1).
+ * row - cell's row (0 to N-1).
+ * val - cell's new value (0 to N, 0 to empty the cell).
+ * description:
+ * sets cell <col,row> to 'val', as a move of the moves-log.
+ * returns SudokuOutOfRange, SudokuFixedCell or SudokuOutOfMemory if the
+ * cell cannot be set, SudokuOk otherwise. the caller checks whether the board was completed
+ * (g->numFilled and g->errorCount).
+ */
+int sudokuSet(Game *g, int col, int row, int val) {
+	if (g->N == 0) {
+		return SudokuNoBoard;
+	}
+	if (col < 0 || col >= g->N || row < 0 || row >= g->N || val < 0 || val > g->N) {
+		return SudokuOutOfRange;
+	}
+	if (isFixedCell(g, getN(g, col, row))) {
+		return SudokuFixedCell;
+	}
+	if (!reserveMoves(g, 1)) {
+		return SudokuOutOfMemory;
+	}
+	setCell(g, col, row, val);
+	return SudokuOk;
+}
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                          2. SOLUTIONS                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * sudokuSolve:
+ * ------------
+ * arguments:
+ * g - the game.
+ * solution - if not NULL, an array of N*N values, filled with a solution
+ * of the board (left to right, then top to bottom).
+ * description:
+ * finds a solution of the board, or takes a cached solution that still
+ * agrees with it (see SolutionCache.c). the board itself is not changed.
+ * returns SudokuErroneous or SudokuUnsolvable if there is no solution,
+ * SudokuOutOfMemory, or SudokuOk otherwise.
+ */
+int sudokuSolve(Game *g, int *solution) {
+	int n, result = 1;
+
+	if (g->N == 0) {
+		return SudokuNoBoard;
+	}
+	if (isErroneous(g)) {
+		return SudokuErroneous;
+	}
+	if (!loadCachedSolution(g)) {
+		result = solveAndCache(g);
+	}
+	if (result < 0) {
+		return SudokuOutOfMemory;
+	}
+	if (!result) {
+		return SudokuUnsolvable;
+	}
+	for (n = 0; solution && n < g->N*g->N; n++) {
+		solution[n] = getDemiVal(g, n) ? getDemiVal(g, n) : getVal(g, n);
+	}
+	return SudokuOk;
+}
+
+/*
+ * sudokuHint:
+ * -----------
+ * arguments:
+ * g - the game.
+ * col - cell's column (0 to N-1).
+ * row - cell's row (0 to N-1).
+ * val - set to the value of cell <col,row> in a solution of the board.
+ * description:
+ * takes a cached solution that still agrees with the board, or else
+ * solves the board (unless an empty cell has no legal value), and
+ * gives the value of cell <col,row> in it.
+ * returns SudokuOutOfRange, SudokuErroneous, SudokuFixedCell,
+ * SudokuFilledCell, SudokuUnsolvable or SudokuOutOfMemory if there is
+ * no hint, SudokuOk otherwise.
+ */
+int sudokuHint(Game *g, int col, int row, int *val) {
+	int result = 1;
+
+	if (g->N == 0) {
+		return SudokuNoBoard;
+	}
+	if (col < 0 || col >= g->N || row < 0 || row >= g->N) {
+		return SudokuOutOfRange;
+	}
+	if (isErroneous(g)) {
+		return SudokuErroneous;
+	}
+	if (isFixedCell(g, getN(g, col, row))) {
+		return SudokuFixedCell;
+	}
+	if (getVal(g, getN(g, col, row))) {
+		return SudokuFilledCell;
+	}
+	if (!loadCachedSolution(g)) {
+		result = hasDeadCell(g) ? 0 : solveAndCache(g);
+	}
+	if (result < 0) {
+		return SudokuOutOfMemory;
+	}
+	if (!result) {
+		return SudokuUnsolvable;
+	}
+	*val = getDemiVal(g, getN(g, col, row));
+	return SudokuOk;
+}
+
+/*
+ * sudokuCount:
+ * ------------
+ * arguments:
+ * g - the game.
+ * numThreads - the number of threads to count with (0 for all cores).
+ * count - set to the number of solutions of the board.
+ * threadsUsed - set to the number of threads that counted (see countParallel).
+ *               it is less than asked for if there was not enough memory to
+ *               split the count, or a thread couldn't be started.
+ * description:
+ * counts the solutions of the board, using constraint propagation followed
+ * by the bitmask search engine, split between 'numThreads' threads.
+ * returns SudokuErroneous if the board contains erroneous values,
+ * SudokuOutOfMemory, or SudokuOk otherwise.
+ */
+int sudokuCount(Game *g, int numThreads, long *count, int *threadsUsed) {
+	SolverState s;
+
+	if (g->N == 0) {
+		return SudokuNoBoard;
+	}
+	if (isErroneous(g)) {
+		return SudokuErroneous;
+	}
+	if (numThreads == 0) {
+		numThreads = getNumCores();
+	}
+	*count = 0;
+	*threadsUsed = numThreads; /*unless the count is split (a board found unsolvable by propagation isn't)*/
+	if (!createSolver(&s, g->blockW, g->blockH)) {
+		return SudokuOutOfMemory;
+	}
+	if (loadSolverFromGame(g, &s) && propagate(&s)) {
+		*count = countParallel(&s, numThreads, threadsUsed);
+	}
+	freeSolver(&s);
+	return SudokuOk;
+}
+
+/*
+ * sudokuCheckUnique:
+ * ------------------
+ * arguments:
+ * g - the game.
+ * uniqueness - set to 0 if the board has no solution, 1 if it has a
+ * unique solution, and 2 if it has more than one.
+ * description:
+ * finds out whether the board has a unique solution. unlike sudokuCount,
+ * the search stops once a second solution is found.
+ * returns SudokuErroneous if the board contains erroneous values,
+ * SudokuOutOfMemory, or SudokuOk otherwise.
+ */
+int sudokuCheckUnique(Game *g, int *uniqueness) {
+	if (g->N == 0) {
+		return SudokuNoBoard;
+	}
+	if (isErroneous(g)) {
+		return SudokuErroneous;
+	}
+	*uniqueness = boardUniqueness(g);
+	if (*uniqueness < 0) {
+		return SudokuOutOfMemory;
+	}
+	return SudokuOk;
+}
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                           3. GENERATE                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * sudokuGenerate:
+ * ---------------
+ * arguments:
+ * g - the game.
+ * x - number of cells to be randomly filled.
+ * y - number of cells not to erase.
+ * description:
+ * fills the (empty) board with Y cells of a random full grid, as a single
+ * move (see tryGenerate). any X cells of the grid are X random cells filled
+ * with random legal values, so 'x' only has to be in range.
+ * returns SudokuOutOfRange (x or y is not in 0 to the number of empty cells),
+ * SudokuNotEmpty, SudokuGeneratorFailed or SudokuOutOfMemory if no puzzle
+ * was generated, SudokuOk otherwise.
+ */
+int sudokuGenerate(Game *g, int x, int y) {
+	int numEmptyCells = g->N*g->N - g->numFilled;
+
+	if (g->N == 0) {
+		return SudokuNoBoard;
+	}
+	if (x < 0 || x > numEmptyCells || y < 0 || y > numEmptyCells) {
+		return SudokuOutOfRange;
+	}
+	if (g->numFilled != 0) {
+		return SudokuNotEmpty;
+	}
+	return tryGenerate(g, y);
+}
+
+/*
+ * sudokuGenerateUnique:
+ * ---------------------
+ * arguments:
+ * g - the game.
+ * target - the number of clues to stop at (0 for a minimal puzzle).
+ * clues - set to the number of clues of the generated puzzle.
+ * description:
+ * fills the (empty) board with a puzzle that has a unique solution, as a
+ * single move (see tryGenerateUnique). unless 'target' clues are left, the
+ * puzzle is minimal, except on large boards, where a uniqueness check that
+ * runs too long is given up and its clue is kept.
+ * returns SudokuOutOfRange (target is not in 0 to N*N), SudokuNotEmpty,
+ * SudokuGeneratorFailed or SudokuOutOfMemory if no puzzle was generated,
+ * SudokuNotMinimal if the puzzle was generated but a check was given up
+ * (so it may not be minimal), SudokuOk otherwise.
+ */
+int sudokuGenerateUnique(Game *g, int target, int *clues) {
+	if (g->N == 0) {
+		return SudokuNoBoard;
+	}
+	if (target < 0 || target > g->N*g->N) {
+		return SudokuOutOfRange;
+	}
+	if (g->numFilled != 0) {
+		return SudokuNotEmpty;
+	}
+	return tryGenerateUnique(g, target, clues);
+}
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                            4. MOVES                             *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * sudokuUndo:
+ * -----------
+ * arguments:
+ * g - the game.
+ * moves - set to the moves of the step that was undone (see moveCell,
+ * moveOldVal and moveNewVal). they stay valid until the next move is made.
+ * numMoves - set to the number of these moves.
+ * description:
+ * undoes the last step done: a move, or a group of moves.
+ * returns SudokuNoMoves if no step is done, SudokuOk otherwise.
+ */
+int sudokuUndo(Game *g, const Move **moves, int *numMoves) {
+	int first;
+	if (g->N == 0) {
+		return SudokuNoBoard;
+	}
+	if (g->log.curr == 0) {
+		return SudokuNoMoves;
+	}
+	*numMoves = lastStep(g, &first);
+	*moves = g->log.moves + first;
+	undoAny(g);
+	return SudokuOk;
+}
+
+/*
+ * sudokuRedo:
+ * -----------
+ * arguments:
+ * g - the game.
+ * moves - set to the moves of the step that was redone. they stay valid
+ * until the next move is made.
+ * numMoves - set to the number of these moves.
+ * description:
+ * redoes the next step that was undone: a move, or a group of moves.
+ * returns SudokuNoMoves if there is no such step, SudokuOk otherwise.
+ */
+int sudokuRedo(Game *g, const Move **moves, int *numMoves) {
+	int first;
+	if (g->N == 0) {
+		return SudokuNoBoard;
+	}
+	if (g->log.curr == g->log.numMoves) {
+		return SudokuNoMoves;
+	}
+	*numMoves = nextStep(g, &first);
+	*moves = g->log.moves + first;
+	redoAny(g);
+	return SudokuOk;
+}
+
+/*
+ * sudokuJump:
+ * -----------
+ * arguments:
+ * g - the game.
+ * k - the number of steps to be done (0 to the number of steps).
+ * numSteps - set to the number of steps in the moves-log, done or undone.
+ * description:
+ * undoes or redoes steps, until exactly 'k' of them are done (see jumpToStep).
+ * returns SudokuOutOfRange if 'k' is not in range, SudokuOk otherwise.
+ */
+int sudokuJump(Game *g, int k, int *numSteps) {
+	if (g->N == 0) {
+		return SudokuNoBoard;
+	}
+	*numSteps = g->log.numSteps;
+	if (k < 0 || k > g->log.numSteps) {
+		return SudokuOutOfRange;
+	}
+	jumpToStep(g, k);
+	return SudokuOk;
+}
+
+/*
+ * sudokuReset:
+ * ------------
+ * arguments:
+ * g - the game.
+ * description:
+ * undoes all the steps, and clears the moves-log. the board is restored
+ * from the copy taken when it was started (restoreSnapshot), without undoing
+ * the moves one by one.
+ * returns SudokuOk.
+ */
+int sudokuReset(Game *g) {
+	if (g->N == 0) {
+		return SudokuNoBoard;
+	}
+	restoreSnapshot(g);
+	g->log.curr = 0;
+	g->log.step = 0;
+	clearNextMoves(g);
+	return SudokuOk;
+}
+
+/*
+ * sudokuAutofill:
+ * ---------------
+ * arguments:
+ * g - the game.
+ * all - 0 to fill in a single pass (fillSingles), 1 to fill until no cell
+ * is forced (fillAllSingles).
+ * cells - an array of N*N numbers (left to right, then top to bottom),
+ * filled with the cells set, in the order they were set.
+ * numCells - set to the number of cells set.
+ * description:
+ * sets the empty cells that have a single legal value, as a single group
+ * of moves. if no cell is set, nothing is recorded. the caller checks
+ * whether the board was completed (g->numFilled and g->errorCount).
+ * returns SudokuErroneous, SudokuOutOfMemory, or SudokuOk otherwise.
+ */
+int sudokuAutofill(Game *g, int all, int *cells, int *numCells) {
+	int count;
+	if (g->N == 0) {
+		return SudokuNoBoard;
+	}
+	if (isErroneous(g)) {
+		return SudokuErroneous;
+	}
+	count = all ? fillAllSingles(g, cells) : fillSingles(g, cells);
+	if (count < 0) {
+		return SudokuOutOfMemory;
+	}
+	*numCells = count;
+	return SudokuOk;
+}
@@ -0,0 +1,56 @@
+/*
+ * Sudoku.h
+ *
+ * this file allows other modules, and programs linked with libsudoku,
+ * to use the sudoku engine (see Sudoku.c).
+ * a game is prepared with initGame and released with freeGame, and its
+ * cells are read with getVal, isFixedCell and isErrorCell (AuxMethods.h).
+ * every game generates from its own random numbers, seeded with seedGame.
+ */
+
+#ifndef SUDOKU_H_
+#define SUDOKU_H_
+
+#include "DataStructures.h"
+#include "AuxMethods.h"
+
+#define MAX_N 25 /*the maximal number of values in a row (blockW*blockH)*/
+
+/*
+ * SudokuResult:
+ * -------------
+ * the result codes returned by the functions of the engine.
+ */
+enum SudokuResult{
+	SudokuOk,
+	SudokuFileError, /*the file cannot be opened, created or written*/
+	SudokuOutOfRange, /*an argument is not in its range*/
+	SudokuFixedCell, /*the cell is fixed*/
+	SudokuFilledCell, /*the cell already contains a value*/
+	SudokuErroneous, /*the board contains erroneous values*/
+	SudokuUnsolvable, /*the board has no solution*/
+	SudokuNotEmpty, /*the board must be empty*/
+	SudokuGeneratorFailed,
+	SudokuNoBoard, /*no board was started (by sudokuNew or sudokuLoad)*/
+	SudokuOutOfMemory, /*there is not enough memory (the game is left as it was)*/
+	SudokuNotMinimal, /*a unique puzzle was generated, but it may not be minimal*/
+	SudokuNoMoves /*there is no move to undo or redo*/
+};
+
+int sudokuNew(Game *g, int blockW, int blockH, enum Mode m);
+int sudokuLoad(Game *g, const char *path, enum Mode m);
+int sudokuSave(Game *g, const char *path, int *uniqueness);
+int sudokuSet(Game *g, int col, int row, int val);
+int sudokuSolve(Game *g, int *solution);
+int sudokuHint(Game *g, int col, int row, int *val);
+int sudokuCount(Game *g, int numThreads, long *count, int *threadsUsed);
+int sudokuCheckUnique(Game *g, int *uniqueness);
+int sudokuGenerate(Game *g, int x, int y);
+int sudokuGenerateUnique(Game *g, int target, int *clues);
+int sudokuUndo(Game *g, const Move **moves, int *numMoves);
+int sudokuRedo(Game *g, const Move **moves, int *numMoves);
+int sudokuJump(Game *g, int k, int *numSteps);
+int sudokuReset(Game *g);
+int sudokuAutofill(Game *g, int all, int *cells, int *numCells);
+
+#endif /* SUDOKU_H_ */
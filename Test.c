@@ -0,0 +1,516 @@
+/*
+ * Test.c
+ *
+ * this file contains the regression tests of the engine (see Sudoku.h),
+ * built and run by 'make check'. every test prints a line for each failed
+ * check, and the program exits with EXIT_FAILURE if any check failed.
+ * contents:
+ * 1. auxiliary functions - expect, loadText, isSolution. (private)
+ * 2. tests - testNoBoard, testTruncatedFile, testParallelCount, testSolvers,
+ *    testMoves, testBoardHash, testSolutionCache, testGenerateUnique. (private)
+ * 3. main.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "DataStructures.h"
+#include "AuxMethods.h"
+#include "Solver.h"
+#include "Propagation.h"
+#include "DancingLinks.h"
+#include "ParallelCount.h"
+#include "Sudoku.h"
+
+#define TEST_FILE "sudoku-test.txt" /*the file boards are written to, and loaded from*/
+#define TEST_STEPS 70 /*steps in the moves-log of testMoves, past two checkpoints (taken every 32 steps)*/
+
+int numFailed = 0; /*number of failed checks*/
+
+/*a 9x9 puzzle with a unique solution*/
+const char *puzzle =
+	"3 3\n"
+	"5. 3. 0 0 7. 0 0 0 0\n"
+	"6. 0 0 1. 9. 5. 0 0 0\n"
+	"0 9. 8. 0 0 0 0 6. 0\n"
+	"8. 0 0 0 6. 0 0 0 3.\n"
+	"4. 0 0 8. 0 3. 0 0 1.\n"
+	"7. 0 0 0 2. 0 0 0 6.\n"
+	"0 6. 0 0 0 0 2. 8. 0\n"
+	"0 0 0 4. 1. 9. 0 0 5.\n"
+	"0 0 0 0 8. 0 0 7. 9.\n";
+
+/*the same puzzle with its last two rows emptied, so it has many solutions*/
+const char *openPuzzle =
+	"3 3\n"
+	"5. 3. 0 0 7. 0 0 0 0\n"
+	"6. 0 0 1. 9. 5. 0 0 0\n"
+	"0 9. 8. 0 0 0 0 6. 0\n"
+	"8. 0 0 0 6. 0 0 0 3.\n"
+	"4. 0 0 8. 0 3. 0 0 1.\n"
+	"7. 0 0 0 2. 0 0 0 6.\n"
+	"0 6. 0 0 0 0 2. 8. 0\n"
+	"0 0 0 0 0 0 0 0 0\n"
+	"0 0 0 0 0 0 0 0 0\n";
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                    1. AUXILIARY FUNCTIONS                       *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/*
+ * expect:
+ * -------
+ * arguments:
+ * name - the name of the check.
+ * result - the result code returned by the engine.
+ * expected - the result code the engine should return.
+ * description:
+ * prints an error message and counts the failure if 'result' is not 'expected'.
+ */
+void expect(const char *name, int result, int expected) {
+	if (result != expected) {
+		printf("FAILED: %s returned %d, expected %d\n", name, result, expected);
+		numFailed++;
+	}
+}
+
+/*
+ * loadText:
+ * ---------
+ * arguments:
+ * g - the game.
+ * text - a board, in the format of the saved files.
+ * m - game mode.
+ * description:
+ * writes 'text' to TEST_FILE and loads it into g.
+ * returns the result code of sudokuLoad.
+ */
+int loadText(Game *g, const char *text, enum Mode m) {
+	int result;
+	FILE *ofp = fopen(TEST_FILE, "w");
+	if (ofp == NULL) {
+		return SudokuFileError;
+	}
+	fputs(text, ofp);
+	fclose(ofp);
+	result = sudokuLoad(g, TEST_FILE, m);
+	remove(TEST_FILE);
+	return result;
+}
+
+/*
+ * isSolution:
+ * -----------
+ * arguments:
+ * g - the game.
+ * solution - N*N values (left to right, then top to bottom).
+ * description:
+ * returns 1 iff 'solution' is a full grid with no value twice in a row,
+ * column or block, that agrees with every filled cell of the board of g.
+ */
+int isSolution(Game *g, const int *solution) {
+	int n, m, N = g->N;
+	for (n = 0; n < N*N; n++) {
+		if (solution[n] < 1 || solution[n] > N) {
+			return 0;
+		}
+		if (getVal(g, n) && getVal(g, n) != solution[n]) {
+			return 0;
+		}
+		for (m = n + 1; m < N*N; m++) {
+			if (solution[m] == solution[n] && (n/N == m/N || n%N == m%N ||
+					(n/N/g->blockH == m/N/g->blockH && n%N/g->blockW == m%N/g->blockW))) {
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                            2. TESTS                             *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*
+ * testNoBoard:
+ * ------------
+ * description:
+ * a game in INIT mode has no board (N is 0), so validating, hinting,
+ * counting, generating or going through the moves on it must be rejected
+ * rather than reach the solver, the solution cache and the moves-log.
+ */
+void testNoBoard(void) {
+	static Game game;
+	Game *g = &game;
+	int val, uniqueness, cells[1], numCells;
+	long count;
+	int threads;
+	const Move *moves;
+
+	initGame(g);
+	expect("sudokuSolve (validate in INIT mode)", sudokuSolve(g, NULL), SudokuNoBoard);
+	expect("sudokuHint", sudokuHint(g, 0, 0, &val), SudokuNoBoard);
+	expect("sudokuCount", sudokuCount(g, 1, &count, &threads), SudokuNoBoard);
+	expect("sudokuCheckUnique", sudokuCheckUnique(g, &uniqueness), SudokuNoBoard);
+	expect("sudokuSet", sudokuSet(g, 0, 0, 1), SudokuNoBoard);
+	expect("sudokuGenerate", sudokuGenerate(g, 0, 0), SudokuNoBoard);
+	expect("sudokuGenerateUnique", sudokuGenerateUnique(g, 0, &uniqueness), SudokuNoBoard);
+	expect("sudokuUndo", sudokuUndo(g, &moves, &numCells), SudokuNoBoard);
+	expect("sudokuRedo", sudokuRedo(g, &moves, &numCells), SudokuNoBoard);
+	expect("sudokuJump", sudokuJump(g, 0, &numCells), SudokuNoBoard);
+	expect("sudokuReset", sudokuReset(g), SudokuNoBoard);
+	expect("sudokuAutofill", sudokuAutofill(g, 1, cells, &numCells), SudokuNoBoard);
+
+	/*once a board is started, it can be validated*/
+	expect("sudokuNew", sudokuNew(g, 3, 3, Solve), SudokuOk);
+	expect("sudokuSolve (empty board)", sudokuSolve(g, NULL), SudokuOk);
+	freeGame(g);
+}
+
+/*
+ * testTruncatedFile:
+ * ------------------
+ * description:
+ * a file that ends before the whole board was read must not be loaded,
+ * and must leave the game as it was.
+ */
+void testTruncatedFile(void) {
+	static Game game;
+	Game *g = &game;
+	FILE *ofp = fopen(TEST_FILE, "w");
+
+	initGame(g);
+	if (ofp == NULL) {
+		expect("fopen", SudokuFileError, SudokuOk);
+		return;
+	}
+	fprintf(ofp, "3 3\n1 2 3\n");
+	fclose(ofp);
+	expect("sudokuLoad (truncated file)", sudokuLoad(g, TEST_FILE, Solve), SudokuFileError);
+	expect("sudokuSolve (after the failed load)", sudokuSolve(g, NULL), SudokuNoBoard);
+	remove(TEST_FILE);
+	freeGame(g);
+}
+
+
+/*
+ * testParallelCount:
+ * ------------------
+ * description:
+ * counting with any number of threads must give the same number of
+ * solutions as the serial search, and leave the board as it was.
+ */
+void testParallelCount(void) {
+	static Game game;
+	Game *g = &game;
+	SolverState s;
+	long serial, count;
+	int k, threads;
+	char name[64];
+
+	initGame(g);
+	expect("loadText (open puzzle)", loadText(g, openPuzzle, Solve), SudokuOk);
+	if (!createSolver(&s, g->blockW, g->blockH)) {
+		expect("createSolver", SudokuOutOfMemory, SudokuOk);
+		freeGame(g);
+		return;
+	}
+	loadSolverFromGame(g, &s);
+	serial = countSolutions(&s);
+	expect("countSolutions (the open puzzle has several solutions)", serial > 1, 1);
+	for (k = 1; k <= 8; k *= 2) {
+		sprintf(name, "countParallel with %d threads", k);
+		expect(name, countParallel(&s, k, &threads) == serial, 1);
+		expect(name, countSolutions(&s) == serial, 1);
+		expect(name, threads >= 1 && threads <= k, 1);
+	}
+	expect("sudokuCount", sudokuCount(g, 4, &count, &threads), SudokuOk);
+	expect("sudokuCount (same as countSolutions)", count == serial, 1);
+	freeSolver(&s);
+	freeGame(g);
+}
+
+/*
+ * testSolvers:
+ * ------------
+ * description:
+ * the bitmask search, the search after constraint propagation and the
+ * dancing-links solver must all find the unique solution of a puzzle.
+ */
+void testSolvers(void) {
+	static Game game;
+	Game *g = &game;
+	SolverState s;
+	int n, bitmask[MAX_N*MAX_N], propagated[MAX_N*MAX_N], dlx[MAX_N*MAX_N];
+
+	initGame(g);
+	expect("loadText (puzzle)", loadText(g, puzzle, Solve), SudokuOk);
+	if (!createSolver(&s, g->blockW, g->blockH)) {
+		expect("createSolver", SudokuOutOfMemory, SudokuOk);
+		freeGame(g);
+		return;
+	}
+
+	loadSolverFromGame(g, &s);
+	expect("findSolution", findSolution(&s), 1);
+	for (n = 0; n < g->N*g->N; n++) {
+		bitmask[n] = s.vals[n];
+	}
+	expect("findSolution (a solution)", isSolution(g, bitmask), 1);
+
+	loadSolverFromGame(g, &s);
+	expect("propagate", propagate(&s), 1);
+	expect("findSolution (after propagate)", findSolution(&s), 1);
+	for (n = 0; n < g->N*g->N; n++) {
+		propagated[n] = s.vals[n];
+	}
+
+	loadSolverFromGame(g, &s);
+	expect("DLXsolve", DLXsolve(g, &s), 1);
+	for (n = 0; n < g->N*g->N; n++) {
+		dlx[n] = getDemiVal(g, n) ? getDemiVal(g, n) : getVal(g, n);
+	}
+
+	for (n = 0; n < g->N*g->N; n++) {
+		if (propagated[n] != bitmask[n] || dlx[n] != bitmask[n]) {
+			expect("the solvers agree", 0, 1);
+			break;
+		}
+	}
+	freeSolver(&s);
+	freeGame(g);
+}
+
+/*
+ * testMoves:
+ * ----------
+ * description:
+ * a group of moves (autofill) and single moves are recorded past two
+ * checkpoints of the moves-log. jumping to any step, before, at or after
+ * a checkpoint, must give the board reached when that step was done, and
+ * undo and redo must then go one step back and forth. reset must return
+ * to the loaded board.
+ */
+void testMoves(void) {
+	static Game game;
+	Game *g = &game;
+	BoardHash hashes[TEST_STEPS + 1];
+	int filled[TEST_STEPS + 1], errors[TEST_STEPS + 1];
+	int cells[MAX_N*MAX_N], numCells, numEmpty, numMoves, numSteps, i, k;
+	int jumps[] = {TEST_STEPS, 0, 31, 32, 33, 1, 64, 65, 40, TEST_STEPS};
+	const Move *moves;
+	char name[64];
+
+	initGame(g);
+	expect("loadText (puzzle)", loadText(g, puzzle, Solve), SudokuOk);
+	hashes[0] = boardHash(g);
+	filled[0] = g->numFilled;
+	errors[0] = g->errorCount;
+
+	/*step 1 is a group of moves, the other steps set the cells autofill left empty*/
+	expect("sudokuAutofill", sudokuAutofill(g, 0, cells, &numCells), SudokuOk);
+	expect("sudokuAutofill (cells set)", numCells > 1, 1);
+	numEmpty = 0;
+	for (i = 0; i < g->N*g->N; i++) {
+		if (!getVal(g, i)) {
+			cells[numEmpty++] = i;
+		}
+	}
+	for (k = 1; k <= TEST_STEPS; k++) {
+		if (k > 1) {
+			i = cells[(k*7) % numEmpty];
+			expect("sudokuSet", sudokuSet(g, i % g->N, i / g->N, k % (g->N + 1)), SudokuOk);
+		}
+		hashes[k] = boardHash(g);
+		filled[k] = g->numFilled;
+		errors[k] = g->errorCount;
+	}
+
+	for (i = 0; i < (int)(sizeof(jumps)/sizeof(jumps[0])); i++) {
+		k = jumps[i];
+		sprintf(name, "sudokuJump to step %d", k);
+		expect(name, sudokuJump(g, k, &numSteps), SudokuOk);
+		expect(name, numSteps, TEST_STEPS);
+		expect(name, hashes[k].hi == boardHash(g).hi && hashes[k].lo == boardHash(g).lo, 1);
+		expect(name, filled[k] == g->numFilled && errors[k] == g->errorCount, 1);
+		if (k == 0) {
+			expect("sudokuUndo (at step 0)", sudokuUndo(g, &moves, &numMoves), SudokuNoMoves);
+			continue;
+		}
+		sprintf(name, "sudokuUndo from step %d", k);
+		expect(name, sudokuUndo(g, &moves, &numMoves), SudokuOk);
+		expect(name, numMoves, k == 1 ? numCells : 1);
+		expect(name, hashes[k - 1].hi == boardHash(g).hi && hashes[k - 1].lo == boardHash(g).lo, 1);
+		expect(name, filled[k - 1] == g->numFilled && errors[k - 1] == g->errorCount, 1);
+		sprintf(name, "sudokuRedo to step %d", k);
+		expect(name, sudokuRedo(g, &moves, &numMoves), SudokuOk);
+		expect(name, hashes[k].hi == boardHash(g).hi && hashes[k].lo == boardHash(g).lo, 1);
+	}
+	expect("sudokuRedo (at the last step)", sudokuRedo(g, &moves, &numMoves), SudokuNoMoves);
+	expect("sudokuJump (out of range)", sudokuJump(g, TEST_STEPS + 1, &numSteps), SudokuOutOfRange);
+
+	expect("sudokuReset", sudokuReset(g), SudokuOk);
+	expect("sudokuReset (the loaded board)", hashes[0].hi == boardHash(g).hi && hashes[0].lo == boardHash(g).lo, 1);
+	expect("sudokuReset (the loaded board)", filled[0], g->numFilled);
+	expect("sudokuUndo (after reset)", sudokuUndo(g, &moves, &numMoves), SudokuNoMoves);
+	expect("sudokuRedo (after reset)", sudokuRedo(g, &moves, &numMoves), SudokuNoMoves);
+	freeGame(g);
+}
+
+/*
+ * testBoardHash:
+ * --------------
+ * description:
+ * the hash is kept up to date as cells change, so it must come back after
+ * a move is undone, must not depend on the order the cells were set in,
+ * and must be the hash of the same board saved and loaded again.
+ * different boards must (almost surely) have different hashes.
+ */
+void testBoardHash(void) {
+	static Game first, second;
+	BoardHash empty, h;
+	const Move *moves;
+	int numMoves, uniqueness;
+
+	initGame(&first);
+	initGame(&second);
+	expect("sudokuNew", sudokuNew(&first, 3, 3, Edit), SudokuOk);
+	expect("sudokuNew", sudokuNew(&second, 3, 3, Edit), SudokuOk);
+	empty = boardHash(&first);
+
+	expect("sudokuSet", sudokuSet(&first, 0, 0, 1), SudokuOk);
+	h = boardHash(&first);
+	expect("a set changes the hash", h.hi == empty.hi && h.lo == empty.lo, 0);
+	expect("sudokuUndo", sudokuUndo(&first, &moves, &numMoves), SudokuOk);
+	h = boardHash(&first);
+	expect("an undo restores the hash", h.hi == empty.hi && h.lo == empty.lo, 1);
+
+	/*the same cells, set in a different order*/
+	sudokuSet(&first, 0, 0, 1);
+	sudokuSet(&first, 4, 4, 5);
+	sudokuSet(&first, 8, 2, 3);
+	sudokuSet(&second, 8, 2, 3);
+	sudokuSet(&second, 0, 0, 2);
+	sudokuSet(&second, 4, 4, 5);
+	expect("different boards", boardHash(&first).lo == boardHash(&second).lo && boardHash(&first).hi == boardHash(&second).hi, 0);
+	sudokuSet(&second, 0, 0, 1);
+	expect("the same board", boardHash(&first).lo == boardHash(&second).lo && boardHash(&first).hi == boardHash(&second).hi, 1);
+
+	/*a board loaded from a file is hashed from scratch*/
+	expect("sudokuSave", sudokuSave(&first, TEST_FILE, &uniqueness), SudokuOk);
+	expect("sudokuLoad", sudokuLoad(&second, TEST_FILE, Solve), SudokuOk);
+	remove(TEST_FILE);
+	expect("a saved and loaded board", boardHash(&first).lo == boardHash(&second).lo && boardHash(&first).hi == boardHash(&second).hi, 1);
+	freeGame(&first);
+	freeGame(&second);
+}
+
+/*
+ * testSolutionCache:
+ * ------------------
+ * description:
+ * a solution that still agrees with the board must be taken from the
+ * cache, and a cell set against every cached solution must make the board
+ * be solved (and cached) again. either way, the solution must be valid.
+ */
+void testSolutionCache(void) {
+	static Game game;
+	Game *g = &game;
+	int solution[MAX_N*MAX_N], first[MAX_N*MAX_N], n, other;
+	const Move *moves;
+	int numMoves;
+
+	initGame(g);
+	expect("sudokuNew", sudokuNew(g, 2, 2, Solve), SudokuOk);
+	expect("sudokuSolve (miss)", sudokuSolve(g, first), SudokuOk);
+	expect("sudokuSolve (a solution)", isSolution(g, first), 1);
+	expect("sudokuSolve (cached)", g->cache.numSolutions, 1);
+
+	/*a cell set as in the cached solution: a hit*/
+	expect("sudokuSet", sudokuSet(g, 0, 0, first[0]), SudokuOk);
+	expect("sudokuSolve (hit)", sudokuSolve(g, solution), SudokuOk);
+	expect("sudokuSolve (hit)", g->cache.numSolutions, 1);
+	for (n = 0; n < g->N*g->N; n++) {
+		if (solution[n] != first[n]) {
+			expect("sudokuSolve (the cached solution)", 0, 1);
+			break;
+		}
+	}
+
+	/*a cell set against the cached solution: a miss*/
+	other = first[1] % g->N + 1;
+	expect("sudokuSet", sudokuSet(g, 1, 0, other), SudokuOk);
+	expect("sudokuSolve (miss)", sudokuSolve(g, solution), SudokuOk);
+	expect("sudokuSolve (a new solution)", isSolution(g, solution) && solution[1] == other, 1);
+	expect("sudokuSolve (cached)", g->cache.numSolutions, 2);
+
+	/*undone, the board agrees with the first solution again: a hit*/
+	expect("sudokuUndo", sudokuUndo(g, &moves, &numMoves), SudokuOk);
+	expect("sudokuSolve (hit after undo)", sudokuSolve(g, solution), SudokuOk);
+	expect("sudokuSolve (hit after undo)", isSolution(g, solution), 1);
+	expect("sudokuSolve (hit after undo)", g->cache.numSolutions, 2);
+	freeGame(g);
+}
+
+/*
+ * testGenerateUnique:
+ * -------------------
+ * description:
+ * a generated 9x9 puzzle must have a unique solution, and be minimal:
+ * emptying any of its clues must leave a board with several solutions.
+ */
+void testGenerateUnique(void) {
+	static Game game;
+	Game *g = &game;
+	int seed, n, clues, uniqueness, minimal;
+	const Move *moves;
+	int numMoves;
+
+	initGame(g);
+	for (seed = 1; seed <= 3; seed++) {
+		seedGame(g, (unsigned long)seed);
+		expect("sudokuNew", sudokuNew(g, 3, 3, Edit), SudokuOk);
+		expect("sudokuGenerateUnique", sudokuGenerateUnique(g, 0, &clues), SudokuOk);
+		expect("sudokuGenerateUnique (clues)", clues, g->numFilled);
+		expect("sudokuCheckUnique", sudokuCheckUnique(g, &uniqueness), SudokuOk);
+		expect("sudokuCheckUnique (a generated puzzle)", uniqueness, 1);
+		minimal = 1;
+		for (n = 0; n < g->N*g->N; n++) {
+			if (!getVal(g, n)) {
+				continue;
+			}
+			sudokuSet(g, n % g->N, n / g->N, 0);
+			sudokuCheckUnique(g, &uniqueness);
+			minimal = minimal && uniqueness == 2;
+			sudokuUndo(g, &moves, &numMoves);
+		}
+		expect("sudokuGenerateUnique (minimal)", minimal, 1);
+	}
+	freeGame(g);
+}
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                             3. MAIN                             *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+int main(void) {
+	testNoBoard();
+	testTruncatedFile();
+	testParallelCount();
+	testSolvers();
+	testMoves();
+	testBoardHash();
+	testSolutionCache();
+	testGenerateUnique();
+	if (numFailed) {
+		printf("%d check(s) failed\n", numFailed);
+		return EXIT_FAILURE;
+	}
+	printf("All checks passed\n");
+	return EXIT_SUCCESS;
+}
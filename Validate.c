@@ -1,19 +1,30 @@
 /*
  * Validate.c
  *
- * this file implements the ILP-solve algorithm using the Gurobi library.
+ * this file implements the function that solves the board, ILPvalidate.
+ * the board is first reduced by constraint propagation. what is left is
+ * solved by default as an exact-cover problem by the dancing-links solver
+ * (DancingLinks.c). when compiled with USE_GUROBI, it is solved as an ILP
+ * problem using the Gurobi library instead.
  * contents:
- * 1. auxiliary functions that support our ILP-solve function. (private)
- * 2. ILP-solve function - ILPvalidate. (public)
+ * 1. auxiliary functions that support our ILP-solve function. (private, USE_GUROBI only)
+ * 2. ILP-solve functions - ILPinit, ILPsolve (private), ILPvalidate and ILPcleanup. (public)
  *
  */
 
 #include <stdlib.h>
-#include <stdio.h>
 #include "DataStructures.h"
 #include "AuxMethods.h"
+#include "Solver.h"
+#include "Propagation.h"
+#include "DancingLinks.h"
+
+#ifdef USE_GUROBI
+#include <string.h>
 #include "gurobi_c.h"
 
+GRBenv *gurobiEnv = NULL; /*created once, by ILPinit*/
+
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
  *                    1. AUXILIARY FUNCTIONS                       *
@@ -21,171 +32,142 @@
 
 
 /*
- * storeSolution:
- * --------------
+ * presolve:
+ * ---------
  * arguments:
- * model - gurobi model.
- * solution - an array to extract the solution into.
+ * s - a propagated state of the game board.
+ * varIndex - an array of N*N*N ints. varIndex[n*N + v] is set to the number of
+ *            the variable representing "cell n holds v+1", or -1 if there is none.
+ * varOption - an array of N*N*N ints. varOption[k] is set to n*N + v of variable k.
  * description:
- * extract a solution from 'model', and stores it in
- * each cell's demiVal field.
+ * creates a variable for every remaining candidate of every empty cell in 's'.
+ * filled cells, and values eliminated by propagation, get no variables.
+ * returns the number of variables, or -1 if an empty cell has no candidates.
  */
-int storeSolution (GRBmodel *model, double *solution) {
-	int error, v,i,j,N = myGame.N;
-	error = GRBgetdblattrarray(model, GRB_DBL_ATTR_X, 0, N*N*N, solution); /*solution extracted from model to 'solution'*/
-	if (error) return error;
+int presolve(SolverState *s, int *varIndex, int *varOption) {
+	int n, v, numVars = 0, N = s->N;
+	unsigned int candidates;
 
-	/*storing the solution in each cell's demiVal field*/
-	for (v=0; v<N; v++) {
-		for (i=0; i<N; i++) {
-			for (j=0; j<N; j++) {
-				if (*(solution + N*N*i + N*j + v) == 1.0) {
-					getCell(i,j)->demiVal = v + 1;
-				}
+	for (n = 0; n < N*N; n++) {
+		for (v = 0; v < N; v++) {
+			varIndex[n*N + v] = -1;
+		}
+		if (s->vals[n]) {
+			continue;
+		}
+		candidates = candidatesOf(s, n);
+		if (!candidates) {
+			return -1;
+		}
+		for (v = 0; v < N; v++) {
+			if (candidates & (1u << v)) {
+				varIndex[n*N + v] = numVars;
+				varOption[numVars] = n*N + v;
+				numVars++;
 			}
 		}
 	}
-	return error;
+	return numVars;
 }
 
 /*
- * addBlockConstraints:
- * --------------------
+ * storeSolution:
+ * --------------
  * arguments:
- * ind - an array of variable indices.
- * val - an array of variable values.
- * model - a gurobi model.
+ * g - the game.
+ * model - gurobi model.
+ * solution - an array to extract the solution into.
+ * numVars - number of variables in 'model'.
+ * varOption - maps every variable to its n*N + v (see presolve).
  * description:
- * adds the constraints, regarding board-blocks, imposed by the
- * current game state, to 'model'.
+ * extract a solution from 'model', and stores it in the demiVal
+ * field of the cells that were left empty by propagation.
  */
-int addBlockConstraints(int *ind, double *val, GRBmodel *model) {
-	int error, count, v,a,b,i,j,N = myGame.N;
-	for (v=0; v<N; v++) {
-		for (a=0; a<myGame.blockH; a++) {
-			for (b=0; b<myGame.blockW; b++) {
-				count = 0;
-				for (i=a*myGame.blockW; i < (a+1)*myGame.blockW; i++) {
-					for (j=b*myGame.blockH; j < (b+1)*myGame.blockH; j++) {
-						ind[count] = N*N*i + N*j + v;
-						val[0] = 1.0;
-						count++;
-					}
-				}
-				error = GRBaddconstr(model, N, ind, val, GRB_EQUAL, 1.0, NULL);
-				if (error) return error;
-			}
+int storeSolution (Game *g, GRBmodel *model, double *solution, int numVars, int *varOption) {
+	int error = 0, k, N = g->N;
+	error = GRBgetdblattrarray(model, GRB_DBL_ATTR_X, 0, numVars, solution); /*solution extracted from model to 'solution'*/
+	if (error) return error;
+
+	/*storing the solution in each cell's demiVal field*/
+	for (k = 0; k < numVars; k++) {
+		if (solution[k] > 0.5) {
+			setDemiVal(g, varOption[k]/N, varOption[k]%N + 1);
 		}
 	}
 	return error;
 }
 
 /*
- * addRowConstraints:
- * ------------------
+ * addCellSingleValueConstraint:
+ * -----------------------------
  * arguments:
+ * s - the presolved state.
+ * varIndex - maps every (cell, value) to its variable (see presolve).
  * ind - an array of variable indices.
  * val - an array of variable values.
  * model - a gurobi model.
  * description:
- * adds the constraints, regarding board-rows, imposed by the
- * current game state, to 'model'.
+ * adds to 'model' the constraints imposed by the fact that every
+ * empty cell must hold a single one of its candidates.
  */
-int addRowConstraints (int *ind, double *val, GRBmodel *model) {
-	int error, v, i, j, N = myGame.N;
-	for (v=0; v<N; v++) {
-		for (j=0; j<N; j++) {
-			for (i=0; i<N; i++) {
-				ind[i] = N*N*i + N*j + v;
-				val[i] = 1.0;
+int addCellSingleValueConstraint (SolverState *s, int *varIndex, int *ind, double *val, GRBmodel *model) {
+	int error = 0, n, v, count, N = s->N;
+	for (n = 0; n < N*N; n++) {
+		if (s->vals[n]) {
+			continue;
+		}
+		count = 0;
+		for (v = 0; v < N; v++) {
+			if (varIndex[n*N + v] >= 0) {
+				ind[count] = varIndex[n*N + v];
+				val[count] = 1.0;
+				count++;
 			}
-			error = GRBaddconstr(model, N, ind, val, GRB_EQUAL, 1.0, NULL);
-			if (error) return error;
 		}
+		error = GRBaddconstr(model, count, ind, val, GRB_EQUAL , 1.0, NULL);
+		if (error) return error;
 	}
 	return error;
 }
 
 /*
- * addColsConstraints:
+ * addUnitConstraints:
  * -------------------
  * arguments:
+ * s - the presolved state.
+ * varIndex - maps every (cell, value) to its variable (see presolve).
  * ind - an array of variable indices.
  * val - an array of variable values.
  * model - a gurobi model.
  * description:
- * adds the constraints, regarding board-columns, imposed by the
- * current game state, to 'model'.
+ * adds the constraints regarding board-rows, columns and blocks to 'model':
+ * every value that isn't used in a unit yet must appear exactly once
+ * among the unit's candidate variables.
  */
-int addColsConstraints (int *ind, double *val, GRBmodel *model) {
-	int error, i, j, v, N = myGame.N;
-	for (v=0; v<N; v++) {
-		for (i=0; i<N; i++) {
-			for (j=0; j<N; j++) {
-				ind[j] = N*N*i + N*j + v;
-				val[j] = 1.0;
+int addUnitConstraints (SolverState *s, int *varIndex, int *ind, double *val, GRBmodel *model) {
+	int error = 0, unit, v, i, k, count, N = s->N;
+	for (unit = 0; unit < 3*N; unit++) {
+		for (v = 0; v < N; v++) {
+			if (unitUsed(s, unit) & (1u << v)) {
+				continue;
 			}
-			error = GRBaddconstr(model, N, ind, val, GRB_EQUAL, 1.0, NULL);
-			if (error) return error;
-		}
-	}
-	return error;
-}
-
-/*
- * addCellSingleValueConstraint:
- * -----------------------------
- * arguments:
- * ind - an array of variable indices.
- * val - an array of variable values.
- * model - a gurobi model.
- * description:
- * adds to 'model' the constraints imposed by the fact that every
- * cells must hold a single value and only a single value.
- */
-int addCellSingleValueConstraint (int *ind, double *val, GRBmodel *model) {
-	int error, i, j, v, N = myGame.N;
-	for (i=0; i<N; i++) {
-		for (j=0; j<N; j++) {
-			for (v=0; v<N; v++) {
-				ind[v] = N*N*i + N*j + v;
-				val[v] = 1.0;
+			count = 0;
+			for (i = 0; i < N; i++) {
+				k = varIndex[s->units[unit*N + i]*N + v];
+				if (k >= 0) {
+					ind[count] = k;
+					val[count] = 1.0;
+					count++;
+				}
 			}
-			error = GRBaddconstr(model, N, ind, val, GRB_EQUAL , 1.0, NULL);
+			error = GRBaddconstr(model, count, ind, val, GRB_EQUAL, 1.0, NULL);
 			if (error) return error;
 		}
 	}
 	return error;
 }
 
-/*
- * prepareTypesAndBounds:
- * ----------------------
- * arguments:
- * vtype - an array of gurobi variable types.
- * lb - an array of variables' lower bounds.
- * description:
- * prepares arrays representing variable types (vtype),
- * and variable lower bounds (lb) to be used as arguments
- * when calling GRBnewmodel().
- */
-void prepareTypesAndBounds(char *vtype, double *lb) {
-	int i, j, v, N = myGame.N;
-	Cell *cell;
-	for (i=0; i<N; i++) {
-		for (j=0; j<N; j++) {
-			for (v=0; v<N; v++) {
-				*(vtype + N*N*i + N*j + v) = GRB_BINARY;
-				cell = getCell(i,j);
-				if (cell->val == v + 1) {
-					*(lb + N*N*i + N*j + v) = 1.0;
-				} else {
-					*(lb + N*N*i + N*j + v) = 0.0;
-				}
-			}
-		}
-	}
-}
+#endif /* USE_GUROBI */
 
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -193,46 +175,76 @@ void prepareTypesAndBounds(char *vtype, double *lb) {
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 
+#ifdef USE_GUROBI
+
 /*
- * ILPvalidate:
- * ------------
+ * ILPinit:
+ * --------
  * arguments:
  * none.
  * description:
- * solves the game board using ILP with the Gurobi library.
- * prints error if fails.
+ * creates the Gurobi environment that is used by every ILPvalidate call.
+ * prints nothing; the caller reports a failure.
+ * returns 1 iff the environment is ready.
+ */
+int ILPinit(void) {
+	int error;
+	if (gurobiEnv != NULL) {
+		return 1;
+	}
+	error = GRBloadenv(&gurobiEnv, NULL);
+	if (error) {
+		GRBfreeenv(gurobiEnv);
+		gurobiEnv = NULL;
+		return 0;
+	}
+	GRBsetintparam(gurobiEnv, GRB_INT_PAR_LOGTOCONSOLE, 0);
+	return 1;
+}
+
+/*
+ * ILPsolve:
+ * ---------
+ * arguments:
+ * g - the game.
+ * s - a propagated state of the game board, with empty cells left.
+ * description:
+ * solves the board in 's' using ILP with the Gurobi library.
+ * the model only contains variables for the remaining candidates
+ * of the empty cells, and constraints over them.
+ * if Gurobi fails, no solution is found (nothing is printed).
  * if a solution was successfully found, stores the solution in the cells'
  * demiVal field.
- * returns 1 iff a solution was found.
+ * returns 1 if a solution was found, 0 if there is none, and -1 if there
+ * is not enough memory.
  */
-int ILPvalidate() {
-	GRBenv   	*env   = NULL;
+int ILPsolve(Game *g, SolverState *s) {
 	GRBmodel 	*model = NULL;
-	int      	error, result, N = myGame.N;
-	double		*lb = calloc(N*N*N, sizeof(double));
+	int      	error = 0, result = 0, numVars, N = s->N;
+	int			*varIndex = calloc(N*N*N, sizeof(int));
+	int			*varOption = calloc(N*N*N, sizeof(int));
 	double		*solution = calloc(N*N*N, sizeof(double));
 	char		*vtype = calloc(N*N*N, sizeof(char));
 	int			*ind = calloc(N, sizeof(int));
 	double		*val = calloc(N, sizeof(double));
 
-	/*create environment*/
-	error = GRBloadenv(&env, NULL);
-	GRBsetintparam(env, GRB_INT_PAR_LOGTOCONSOLE, 0);
-	if (error) goto END;
+	if (!varIndex || !varOption || !solution || !vtype || !ind || !val) {
+		result = -1;
+		goto FREE;
+	}
+	numVars = presolve(s, varIndex, varOption);
+	if (numVars <= 0) goto FREE;
+	if (!ILPinit()) goto FREE;
 
 	/*create model*/
-	prepareTypesAndBounds(vtype, lb);
-	error = GRBnewmodel(env, &model, NULL , N*N*N, NULL, (double*)lb, NULL, (char*)vtype, NULL);
+	memset(vtype, GRB_BINARY, numVars);
+	error = GRBnewmodel(gurobiEnv, &model, NULL , numVars, NULL, NULL, NULL, vtype, NULL);
 	if (error) goto END;
 
 	/*add constraints imposed by cols, rows, blocks, and cells having to containt a single value*/
-	error = addCellSingleValueConstraint(ind, val, model);
-	if (error) goto END;
-	error = addColsConstraints(ind, val, model);
-	if (error) goto END;
-	error = addRowConstraints(ind, val, model);
+	error = addCellSingleValueConstraint(s, varIndex, ind, val, model);
 	if (error) goto END;
-	error = addBlockConstraints(ind, val, model);
+	error = addUnitConstraints(s, varIndex, ind, val, model);
 	if (error) goto END;
 	error = GRBoptimize(model);
 	if (error) goto END;
@@ -248,15 +260,18 @@ int ILPvalidate() {
 	}
 
 	/*store the solution*/
-	error = storeSolution(model, solution);
+	error = storeSolution(g, model, solution, numVars, varOption);
 	if (error) goto END;
 
-	/*free memory, report errors and return result*/
+	/*free memory and return result*/
 	END:
-	if (error) printf("ERROR: %s\n", GRBgeterrormsg(env));
+	if (error) {
+		result = 0;
+	}
 	GRBfreemodel(model);
-	GRBfreeenv(env);
-	free(lb);
+	FREE:
+	free(varIndex);
+	free(varOption);
 	free(solution);
 	free(vtype);
 	free(ind);
@@ -264,4 +279,90 @@ int ILPvalidate() {
 	return result;
 }
 
+/*
+ * ILPcleanup:
+ * -----------
+ * arguments:
+ * none.
+ * description:
+ * frees the Gurobi environment.
+ */
+void ILPcleanup(void) {
+	GRBfreeenv(gurobiEnv);
+	gurobiEnv = NULL;
+}
+
+#else
+
+/*
+ * ILPsolve:
+ * ---------
+ * arguments:
+ * g - the game.
+ * s - a propagated state of the game board, with empty cells left.
+ * description:
+ * solves the board in 's' with the dancing-links solver.
+ * if a solution was successfully found, stores the solution in the cells'
+ * demiVal field.
+ * returns 1 if a solution was found, 0 if there is none, and -1 if there
+ * is not enough memory.
+ */
+int ILPsolve(Game *g, SolverState *s) {
+	return DLXsolve(g, s);
+}
+
+/*
+ * ILPinit:
+ * --------
+ * arguments:
+ * none.
+ * description:
+ * the dancing-links solver needs no environment. returns 1.
+ */
+int ILPinit(void) {
+	return 1;
+}
+
+/*
+ * ILPcleanup:
+ * -----------
+ * arguments:
+ * none.
+ * description:
+ * the dancing-links solver keeps no state between calls. does nothing.
+ */
+void ILPcleanup(void) {
+}
+
+#endif
 
+
+/*
+ * ILPvalidate:
+ * ------------
+ * arguments:
+ * g - the game.
+ * description:
+ * solves the game board. the board is first reduced by constraint
+ * propagation (Propagation.c), which solves most puzzles on its own.
+ * only if empty cells are left, the solver (Gurobi or dancing links)
+ * is run on the reduced board.
+ * if a solution was successfully found, stores the solution in the cells'
+ * demiVal field.
+ * returns 1 if a solution was found, 0 if there is none, and -1 if there
+ * is not enough memory.
+ */
+int ILPvalidate(Game *g) {
+	SolverState s;
+	int result = 0;
+
+	if (!createSolver(&s, g->blockW, g->blockH)) {
+		return -1;
+	}
+	if (loadSolverFromGame(g, &s) && propagate(&s)) {
+		storeSolverValues(g, &s);
+		result = (s.numEmpty == 0) ? 1 : ILPsolve(g, &s);
+	}
+	freeSolver(&s);
+	return result;
+}
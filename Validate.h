@@ -1,12 +1,15 @@
 /*
  * Validate.h
  *
- * this file simply allows other modules to use the function ILPvalidate.
+ * this file allows other modules to use the functions ILPinit,
+ * ILPvalidate and ILPcleanup.
  */
 
 #ifndef VALIDATE_H_
 #define VALIDATE_H_
 
-int ILPvalidate();
+int ILPinit(void);
+int ILPvalidate(Game *g);
+void ILPcleanup(void);
 
 #endif /* VALIDATE_H_ */
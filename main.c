@@ -1,30 +1,116 @@
 /*
  * main.c
  *
- * this file contains our main function, which sets the random seed and
- * calls the function that starts the game.
+ * this file contains our main function, which prepares the solver
+ * and calls the function that starts the game, or runs the batch mode
+ * when asked to.
  *
  */
 
 
 #include "DataStructures.h"
+#include "AuxMethods.h"
+#include "Console.h"
 #include "Game.h"
+#include "Validate.h"
+#include "ParallelCount.h"
+#include "Batch.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
+#include <string.h>
 
 
+/*
+ * batchMode:
+ * ----------
+ * arguments:
+ * argc - number of command-line arguments.
+ * argv - the command-line arguments: --batch in.txt [--out out.txt] [-j N].
+ * description:
+ * solves the puzzles in the input file into the output file (by default,
+ * the standard output) with N worker threads (by default, one per core).
+ * prints an error message if the arguments or the files are not valid,
+ * and a warning if fewer worker threads could be started.
+ * returns the exit status of the program.
+ */
+int batchMode(int argc, char *argv[]) {
+	char *inPath = NULL, *outPath = NULL;
+	FILE *ifp, *ofp = stdout;
+	int i, numThreads = getNumCores(), started;
+	long count;
+
+	/*parse the arguments*/
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--batch") && i + 1 < argc) {
+			inPath = argv[++i];
+		} else if (!strcmp(argv[i], "--out") && i + 1 < argc) {
+			outPath = argv[++i];
+		} else if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+			i++;
+			numThreads = isNum(argv[i]) ? atoi(argv[i]) : 0;
+			if (numThreads < 1 || numThreads > MAX_THREADS) {
+				fprintf(stderr, "Error: value not in range 1-%d\n", MAX_THREADS);
+				return 1;
+			}
+		} else {
+			inPath = NULL;
+			break;
+		}
+	}
+	if (inPath == NULL) {
+		fprintf(stderr, "Usage: sudoku-console --batch in.txt [--out out.txt] [-j N]\n");
+		return 1;
+	}
+
+	/*open the files*/
+	ifp = fopen(inPath, "r");
+	if (ifp == NULL) {
+		fprintf(stderr, "Error: File cannot be opened\n");
+		return 1;
+	}
+	if (outPath != NULL) {
+		ofp = fopen(outPath, "w");
+		if (ofp == NULL) {
+			fprintf(stderr, "Error: File cannot be created or modified\n");
+			fclose(ifp);
+			return 1;
+		}
+	}
+
+	count = batchSolve(ifp, ofp, numThreads, &started);
+	fclose(ifp);
+	if (ofp != stdout) {
+		fclose(ofp);
+	}
+	if (count < 0) {
+		fprintf(stderr, "Error: worker threads could not be started\n");
+		return 1;
+	}
+	if (started < numThreads) {
+		fprintf(stderr, "Warning: only %d of %d worker threads could be started\n", started, numThreads);
+	}
+	return 0;
+}
+
 /*
  * main:
  * -----
  * arguments:
- * none.
+ * argc - number of command-line arguments.
+ * argv - the command-line arguments.
  * description:
- * sets the random seed and
- * calls the function that starts the game.
+ * if started with --batch, runs the batch mode (see batchMode).
+ * otherwise, prepares the solver (the Gurobi environment,
+ * when built with USE_GUROBI, reporting if it failed) and calls the
+ * function that starts the game.
  */
-int main(){
-	srand(time(NULL));
+int main(int argc, char *argv[]){
+	if (argc > 1) {
+		return batchMode(argc, argv);
+	}
+	if (!ILPinit()) {
+		printf("ERROR: the Gurobi environment could not be created\n");
+	}
 	gameLoop();
 	return 0;
 }